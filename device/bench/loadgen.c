@@ -0,0 +1,247 @@
+// beamline-loadgen: replay a configurable command mix over N connections
+// against a running server and report end-to-end latency percentiles.
+//
+//   beamline-loadgen [-H host] [-p port] [-n connections] [-d seconds]
+//                    [-m get|put|mixed|monitor]
+//
+// get/put/mixed issue one in-flight request per connection round-robin
+// and time each request to its response line. monitor subscribes every
+// connection and reports delivered DATA frames per second.
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOADGEN_MAX_CONNS 256
+#define LOADGEN_BUCKETS 40
+
+typedef struct {
+    int fd;
+    char buf[4096];
+    size_t len;
+} conn_t;
+
+static conn_t g_conns[LOADGEN_MAX_CONNS];
+static uint64_t g_lat_buckets[LOADGEN_BUCKETS];
+static uint64_t g_lat_count = 0;
+static uint64_t g_lat_max_ns = 0;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ull) + (uint64_t) ts.tv_nsec;
+}
+
+static void lat_record(uint64_t ns) {
+    int bit = (ns == 0) ? 0 : 63 - __builtin_clzll(ns);
+    if (bit >= LOADGEN_BUCKETS) {
+        bit = LOADGEN_BUCKETS - 1;
+    }
+    g_lat_buckets[bit]++;
+    g_lat_count++;
+    if (ns > g_lat_max_ns) {
+        g_lat_max_ns = ns;
+    }
+}
+
+static uint64_t lat_percentile_ns(double pct) {
+    if (g_lat_count == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t) (pct * (double) g_lat_count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    uint64_t cum = 0;
+    for (int b = 0; b < LOADGEN_BUCKETS; b++) {
+        cum += g_lat_buckets[b];
+        if (cum >= rank) {
+            return 1ull << b;
+        }
+    }
+    return g_lat_max_ns;
+}
+
+static int conn_open(const char *host, int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t) port);
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+        close(fd);
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+// Read one complete line from a connection (blocking)
+static bool conn_read_line(conn_t *conn) {
+    while (true) {
+        char *nl = memchr(conn->buf, '\n', conn->len);
+        if (nl != NULL) {
+            size_t line_len = (size_t) (nl - conn->buf) + 1;
+            memmove(conn->buf, conn->buf + line_len, conn->len - line_len);
+            conn->len -= line_len;
+            return true;
+        }
+        ssize_t n = recv(conn->fd, conn->buf + conn->len, sizeof(conn->buf) - conn->len, 0);
+        if (n <= 0) {
+            return false;
+        }
+        conn->len += (size_t) n;
+    }
+}
+
+static void run_request_mix(int nconns, int seconds, const char *mix) {
+    static const char *const get_cmd = "GET:BL02:RING:CURRENT\n";
+    static const char *const put_cmd = "PUT:BL02:MONO:ENERGY:8000\n";
+
+    uint64_t deadline = now_ns() + (uint64_t) seconds * 1000000000ull;
+    uint64_t ops = 0;
+    uint64_t start = now_ns();
+
+    while (now_ns() < deadline) {
+        for (int c = 0; c < nconns; c++) {
+            const char *cmd = get_cmd;
+            if (strcmp(mix, "put") == 0 || (strcmp(mix, "mixed") == 0 && (ops & 1))) {
+                cmd = put_cmd;
+            }
+
+            uint64_t t0 = now_ns();
+            if (send(g_conns[c].fd, cmd, strlen(cmd), 0) < 0 ||
+                !conn_read_line(&g_conns[c])) {
+                fprintf(stderr, "connection %d dropped\n", c);
+                return;
+            }
+            lat_record(now_ns() - t0);
+            ops++;
+        }
+    }
+
+    double elapsed = (double) (now_ns() - start) / 1e9;
+    printf("mix=%s conns=%d ops=%" PRIu64 " rate=%.0f ops/s\n", mix, nconns, ops,
+           (double) ops / elapsed);
+    printf("latency p50=%" PRIu64 "us p90=%" PRIu64 "us p99=%" PRIu64 "us max=%" PRIu64 "us\n",
+           lat_percentile_ns(0.50) / 1000, lat_percentile_ns(0.90) / 1000,
+           lat_percentile_ns(0.99) / 1000, g_lat_max_ns / 1000);
+}
+
+static void run_monitor_mix(int nconns, int seconds) {
+    static const char *const mon_cmd = "MONITOR:BL02:RING:CURRENT:0\n";
+
+    for (int c = 0; c < nconns; c++) {
+        if (send(g_conns[c].fd, mon_cmd, strlen(mon_cmd), 0) < 0 ||
+            !conn_read_line(&g_conns[c])) { // OK:MONITORING
+            fprintf(stderr, "connection %d dropped\n", c);
+            return;
+        }
+    }
+
+    uint64_t deadline = now_ns() + (uint64_t) seconds * 1000000000ull;
+    uint64_t frames = 0;
+    uint64_t start = now_ns();
+
+    while (now_ns() < deadline) {
+        for (int c = 0; c < nconns; c++) {
+            if (!conn_read_line(&g_conns[c])) {
+                fprintf(stderr, "connection %d dropped\n", c);
+                return;
+            }
+            frames++;
+        }
+    }
+
+    double elapsed = (double) (now_ns() - start) / 1e9;
+    printf("mix=monitor conns=%d frames=%" PRIu64 " rate=%.0f frames/s\n", nconns, frames,
+           (double) frames / elapsed);
+}
+
+int main(int argc, char **argv) {
+    const char *host = "127.0.0.1";
+    int port = 5064;
+    int nconns = 4;
+    int seconds = 5;
+    const char *mix = "get";
+
+    int opt;
+    while ((opt = getopt(argc, argv, "H:p:n:d:m:h")) != -1) {
+        switch (opt) {
+        case 'H':
+            host = optarg;
+            break;
+        case 'p':
+            port = atoi(optarg);
+            break;
+        case 'n':
+            nconns = atoi(optarg);
+            break;
+        case 'd':
+            seconds = atoi(optarg);
+            break;
+        case 'm':
+            mix = optarg;
+            break;
+        default:
+            fprintf(stderr,
+                    "usage: %s [-H host] [-p port] [-n connections] [-d seconds]\n"
+                    "          [-m get|put|mixed|monitor]\n",
+                    argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (nconns < 1 || nconns > LOADGEN_MAX_CONNS || seconds < 1) {
+        fprintf(stderr, "invalid -n/-d (max %d connections)\n", LOADGEN_MAX_CONNS);
+        return EXIT_FAILURE;
+    }
+
+    for (int c = 0; c < nconns; c++) {
+        g_conns[c].fd = conn_open(host, port);
+        g_conns[c].len = 0;
+        if (g_conns[c].fd < 0) {
+            fprintf(stderr, "cannot connect to %s:%d: %s\n", host, port, strerror(errno));
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (strcmp(mix, "monitor") == 0) {
+        run_monitor_mix(nconns, seconds);
+    } else if (strcmp(mix, "get") == 0 || strcmp(mix, "put") == 0 ||
+               strcmp(mix, "mixed") == 0) {
+        run_request_mix(nconns, seconds, mix);
+    } else {
+        fprintf(stderr, "unknown mix: %s\n", mix);
+        return EXIT_FAILURE;
+    }
+
+    for (int c = 0; c < nconns; c++) {
+        close(g_conns[c].fd);
+    }
+    return EXIT_SUCCESS;
+}
@@ -6,16 +6,62 @@
 #define BEAMLINE_BACKLOG 10
 #define BEAMLINE_MAX_CLIENTS 32
 
+// Sharded command execution: BEAMLINE_WORKERS event-loop threads (default
+// 1), each owning a contiguous range of client slots, its own event
+// context and its own SO_REUSEPORT listener. Capped so per-worker state
+// (dirty rings, slot masks) can be statically sized.
+#define BEAMLINE_MAX_WORKERS 8
+
+// Co-located clients: Unix-domain listener (same protocol as TCP) and
+// the shared-memory PV snapshot segment name (see shm.h)
+#define BEAMLINE_UNIX_SOCKET_PATH "/tmp/beamline-sim.sock"
+#define BEAMLINE_SHM_NAME "/beamline-pvs"
+
+// Multicast telemetry fan-out (see mcast.h; group/PVs come from env)
+#define BEAMLINE_MCAST_PORT 5065
+#define BEAMLINE_MCAST_INTERVAL_MS 100
+#define BEAMLINE_MCAST_MAX_PVS 64
+
 // Buffer sizes
 #define BEAMLINE_CMD_BUFFER_SIZE 1024
 #define BEAMLINE_RESPONSE_BUFFER_SIZE 4096
 
-// PV limits
+// Maximum PVs per command (multi-PV MONITOR, batched GET/PUT)
+#define BEAMLINE_MAX_CMD_TARGETS 16
+
+// Per-client output queue (bytes); bounds what a slow consumer can hold
+#define BEAMLINE_SEND_QUEUE_SIZE 65536
+
+// Commands one client may execute per loop iteration. A pipelined burst
+// beyond this yields the loop and resumes round-robin next iteration,
+// so a bulk upload cannot starve interactive clients; responses from
+// one slice are coalesced into a single send
+#define BEAMLINE_CMD_BUDGET 32
+
+// Default registry sizes for the built-in device set; a device file
+// (BEAMLINE_DEVICE_FILE) preallocates registries from its counts header
 #define BEAMLINE_MAX_PVS 128
+#define BEAMLINE_MAX_MOTORS 8
 #define BEAMLINE_PV_NAME_MAX 64
 
-// Timing
-#define BEAMLINE_SELECT_TIMEOUT_MS 100
+// Waveform (array) PVs: per-PV element limit and the shared preallocated
+// element pool all waveform buffers are carved from
+#define BEAMLINE_WAVEFORM_MAX_ELEMENTS 2048
+#define BEAMLINE_WAVEFORM_POOL_ELEMENTS 8192
+
+// History archive: per-PV (time, value) rings appended once per
+// simulation tick, carved from a shared preallocated sample pool
+#define BEAMLINE_HISTORY_MAX_SAMPLES 2048
+#define BEAMLINE_HISTORY_POOL_SAMPLES 65536
+
+// Timing. The network loop is tickless: it sleeps until the next monitor
+// or scan deadline (or indefinitely when idle), so only the simulation
+// tick has a fixed period.
 #define BEAMLINE_MOTOR_UPDATE_INTERVAL_MS 10
 
+// Persistent state file (see persist.h; path comes from the
+// BEAMLINE_STATE_FILE environment variable): how often the mmap'd
+// records are flushed to disk. A crash loses at most this much state.
+#define BEAMLINE_STATE_SYNC_INTERVAL_MS 1000
+
 #endif // BEAMLINE_CONFIG_H
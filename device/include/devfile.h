@@ -0,0 +1,20 @@
+#ifndef BEAMLINE_DEVFILE_H
+#define BEAMLINE_DEVFILE_H
+
+#include <stdbool.h>
+
+// Declarative device-file loader. The file is mmap'd and parsed in a
+// single pass; registries are preallocated from the counts header so a
+// full sector (tens of thousands of PVs) loads well under a second.
+//
+// Format (one directive per line, '#' starts a comment):
+//
+//   counts <pv_lines> <motor_lines>
+//   pv <name> <ai|ao|bi|bo|wf> <min> <max> <none|noise|walk> [nelem]
+//   motor <name> <min> <max> <velocity>
+//
+// The counts line must precede all device lines. Each motor expands to
+// three PVs (setpoint, .RBV, .DMOV) on top of the pv lines.
+bool devfile_load(const char* path);
+
+#endif // BEAMLINE_DEVFILE_H
@@ -1,25 +1,67 @@
 #ifndef BEAMLINE_DEVICES_H
 #define BEAMLINE_DEVICES_H
 
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include "config.h"
 
 typedef enum {
-    PV_AI,  // Analog Input
-    PV_AO,  // Analog Output
-    PV_BI,  // Binary Input
-    PV_BO   // Binary Output
+    PV_AI,       // Analog Input
+    PV_AO,       // Analog Output
+    PV_BI,       // Binary Input
+    PV_BO,       // Binary Output
+    PV_WAVEFORM  // Array of doubles (spectra, image rows)
 } pv_type_t;
 
+// One archived history point: monotonic timestamp (ms) and value. All
+// fields are doubles so GETHIST payloads are a uniform array on the wire.
+typedef struct {
+    double t_ms;
+    double value;
+} pv_hist_sample_t;
+
+// Generic per-tick update kinds, swept as dense SIMD-friendly loops over
+// the registry's value/bound arrays. PVs needing bespoke behaviour use
+// PV_UPDATE_CUSTOM with an update_fn callback.
+typedef enum {
+    PV_UPDATE_NONE,
+    PV_UPDATE_NOISE,   // Uniform noise about the range midpoint
+    PV_UPDATE_WALK,    // Bounded random walk
+    PV_UPDATE_CUSTOM   // update_fn callback
+} pv_update_kind_t;
+
+// Registry record. The per-tick hot state (live value, clamp bounds,
+// update kind, noise stream) lives in dense struct-of-arrays storage
+// inside devices.c so the update sweep never drags these cold name bytes
+// through cache; read values via pv_get/pv_read, write via pv_set.
 typedef struct pv_t {
     char name[BEAMLINE_PV_NAME_MAX];
     pv_type_t type;
-    double value;
     double min;
     double max;
     bool writable;
-    void (*update_fn)(struct pv_t*);  // For simulation
+    void (*update_fn)(struct pv_t*);  // PV_UPDATE_CUSTOM only
+    // On-change monitoring state: one bit per client slot
+    // (BEAMLINE_MAX_CLIENTS must stay <= 32). Written by worker threads,
+    // read by the simulation thread.
+    _Atomic uint32_t subscribers;
+    double deadband;        // Minimum |change| that triggers a notification
+    double notified_value;  // Value at last notification (simulation thread)
+    // Notification-pending bit per worker whose shard subscribes
+    // (BEAMLINE_MAX_WORKERS must stay <= 8)
+    _Atomic uint8_t dirty;
+    // Waveform PVs only: preallocated element buffer (simulation thread;
+    // other threads read through pv_read_wave). NULL/0 for scalar PVs.
+    double *elements;
+    int nelem;
+    // History ring: one sample appended per tick by the simulation
+    // thread, read lock-free through pv_read_hist. NULL/0 when history
+    // is disabled for this PV.
+    pv_hist_sample_t *hist;
+    int hist_depth;
+    _Atomic uint64_t hist_head;  // Total samples ever written
 } pv_t;
 
 typedef struct {
@@ -29,7 +71,7 @@ typedef struct {
     double velocity;   // units/s
     double accel;      // units/s²
     double target;
-    bool moving;
+    _Atomic bool moving;  // Written by the simulation thread
 } motor_t;
 
 // Named parameters struct for pv_register (C23 best practice)
@@ -41,18 +83,46 @@ typedef struct {
         double max;
     } range;
     bool writable;
+    pv_update_kind_t kind;   // Ignored when update_fn is set (CUSTOM)
     void (*update_fn)(pv_t *);
+    int nelem;      // > 0 registers a waveform PV with that many elements
+    int hist_depth; // > 0 keeps a (time, value) ring of that many ticks
 } pv_register_params_t;
 
+// Named parameters struct for motor_register (C23 best practice). The
+// motor name becomes the setpoint PV; .RBV and .DMOV PVs are derived.
+typedef struct {
+    const char *name;
+    struct {
+        double min;
+        double max;
+    } range;
+    double velocity;  // units/s
+} motor_register_params_t;
+
 // Named parameters struct for pattern_match (C23 best practice)
 typedef struct {
     const char *pattern;
     const char *str;
 } pattern_match_params_t;
 
-// Device management
+// Device management. Registries are heap-allocated by devices_prealloc()
+// so a device file can size them for a full sector; devices_init() either
+// loads the file named by BEAMLINE_DEVICE_FILE or falls back to the
+// built-in BL02 set.
+bool devices_prealloc(int max_pvs, int max_motors);
+pv_t* pv_register(pv_register_params_t params);
+motor_t* motor_register(motor_register_params_t params);
 void devices_init(void);
-void devices_update(double dt);  // Called in main loop
+void devices_update(double dt);  // Called on the simulation thread
+// Export scalar values to the shared-memory snapshot (see shm.h); once
+// exported, every tick's publish mirrors into the segment
+bool devices_shm_export(void);
+// Attach the persistent state file named by BEAMLINE_STATE_FILE (see
+// persist.h), restoring saved setpoints and motor state when the file
+// holds a valid prior image; every subsequent tick mirrors into it.
+// Call before the simulation thread starts.
+bool devices_state_attach(void);
 
 // PV operations
 pv_t* pv_find(const char* name);
@@ -60,9 +130,59 @@ double pv_get(pv_t* pv);
 bool pv_set(pv_t* pv, double value);
 int pv_list(const char* pattern, char* buf, size_t len);
 
+// PV handles: stable registry indices resolved once, so hot paths
+// (monitors, dependency lookups in update functions) avoid repeated
+// name hashing. PV_HANDLE_INVALID is returned for unknown names.
+typedef int pv_handle_t;
+#define PV_HANDLE_INVALID (-1)
+
+pv_handle_t pv_handle(const char* name);
+pv_t* pv_from_handle(pv_handle_t handle);
+
+// Worker topology for monitor fan-out: count workers, each owning the
+// slot range [w * (BEAMLINE_MAX_CLIENTS / count), ...) with the last
+// worker taking the remainder. Called once from server_init() before any
+// subscription; defaults to one worker owning every slot.
+void devices_set_workers(int count);
+
+// On-change monitoring: devices_update() marks subscribed PVs dirty when
+// they move beyond their deadband, pushing them onto the dirty ring of
+// every worker whose shard subscribes; each worker drains only its own
+// ring. The deadband is per PV: the last subscriber to set it wins.
+void pv_subscribe(pv_t* pv, int slot, double deadband);
+void pv_unsubscribe_all(int slot);
+int pv_take_dirty(int worker, pv_t** out, int max);
+int pv_dirty_depth(int worker);  // Undrained notifications (STATS gauge)
+
+// Cross-thread access. devices_update() runs on a dedicated simulation
+// thread; worker threads read values through a seqlock snapshot
+// published once per tick and submit writes through a lock-free
+// multi-producer/single-consumer mailbox applied at the next tick.
+double pv_read(const pv_t* pv);  // Snapshot read, safe off the sim thread
+// Preformatted "name=value\n" listing of every PV, rebuilt at most once
+// per published tick; returns the byte length and sets *count. The
+// buffer stays valid (and other workers' rebuilds are held off) until
+// the matching pv_snapshot_release().
+size_t pv_snapshot_text(const char **out, int *count);
+void pv_snapshot_release(void);
+int pv_read_wave(const pv_t* pv, double* out, int max);  // Waveform snapshot
+// Copy up to max most-recent history samples, oldest first. Samples the
+// simulation thread overwrote mid-copy are trimmed from the front, so
+// the result is always a contiguous, untorn window ending at "now".
+int pv_read_hist(const pv_t* pv, pv_hist_sample_t* out, int max);
+bool devices_request_put(pv_t* pv, double value);
+bool devices_request_move(const char* motor_name, double target);
+
 // Motor operations
 motor_t* motor_find(const char* name);
 bool motor_move(const char* motor_name, double target);
 const char* motor_get_status_string(motor_t* motor);
 
+// Trajectory generation, bumped each time a move is applied. Callers
+// that go through devices_request_move() can snapshot it to tell "the
+// queued move has not been applied yet" apart from "the motor arrived":
+// until the generation advances, a false moving flag just means the
+// request is still in the mailbox.
+uint32_t motor_move_generation(const motor_t* motor);
+
 #endif // BEAMLINE_DEVICES_H
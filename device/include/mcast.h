@@ -0,0 +1,24 @@
+#ifndef BEAMLINE_MCAST_H
+#define BEAMLINE_MCAST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Optional UDP multicast publisher for monitor fan-out. A configured PV
+// group is broadcast as one coalesced "DATA:PV1=v1,PV2=v2\n" datagram
+// per interval, so server send cost stays O(1) no matter how many
+// dashboards in the control room join the group. TCP stays the control
+// path; multicast is telemetry only.
+//
+// Configuration (environment, publisher disabled when unset):
+//   BEAMLINE_MCAST_ADDR  multicast group, e.g. 239.0.5.64
+//   BEAMLINE_MCAST_PVS   comma-separated PV names and/or glob patterns,
+//                        e.g. "BL02:RING:CURRENT,BL02:DET:*"
+
+bool mcast_init(void);     // Returns true if the publisher is active
+bool mcast_active(void);
+int64_t mcast_deadline_ms(void);          // Next publish time (active only)
+void mcast_service(int64_t now_ms);       // Publish if the interval elapsed
+void mcast_close(void);
+
+#endif // BEAMLINE_MCAST_H
@@ -0,0 +1,70 @@
+#ifndef BEAMLINE_PERSIST_H
+#define BEAMLINE_PERSIST_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// mmap-backed persistent PV and motor state for warm restarts. Without
+// it every restart cold-starts the registry (motors at zero, setpoints
+// at defaults) and deploys pay a re-homing storm of MOVE commands; with
+// it a restarted server resumes from the last published tick.
+//
+// File layout (path from the BEAMLINE_STATE_FILE environment variable):
+//   persist_header_t
+//   persist_pv_rec_t[pv_count]       -- scalar values, registry order
+//   persist_motor_rec_t[motor_count] -- target + moving, registry order
+//
+// The simulation thread updates the records in place once per tick
+// under the same seqlock idiom as the shared-memory export, and the
+// mapping is msync'd asynchronously every
+// BEAMLINE_STATE_SYNC_INTERVAL_MS. A file whose header fails to
+// validate -- or whose seq is odd, meaning the writer died mid-publish
+// -- is discarded on open and the server cold-starts; a crash between
+// flushes loses at most that interval of state.
+
+#define BEAMLINE_STATE_MAGIC 0x424C5354u // "BLST"
+#define BEAMLINE_STATE_VERSION 1u
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t pv_count;
+    uint32_t motor_count;
+    _Atomic uint64_t seq; // Odd while the writer is mid-publish
+} persist_header_t;
+
+typedef struct {
+    uint64_t hash; // FNV-1a 64 of the PV name (shm_name_hash)
+    double value;
+} persist_pv_rec_t;
+
+typedef struct {
+    uint64_t hash; // Hash of the setpoint PV name
+    double target;
+    uint32_t moving;
+    uint32_t pad;
+} persist_motor_rec_t;
+
+// Writer side (simulation process). persist_open() maps the state file,
+// creating it when absent, and retains any valid prior records for the
+// lookup calls; every other call is a no-op until it succeeds. Records
+// are keyed by name hash, so prior state survives registry reordering
+// and device-file edits; records with no matching name are dropped.
+bool persist_open(const char *path, int pv_count, int motor_count);
+bool persist_loaded(void); // True when the file held valid prior state
+bool persist_lookup_pv(uint64_t hash, double *value);
+bool persist_lookup_motor(uint64_t hash, double *target, bool *moving);
+void persist_set_pv_hash(int idx, uint64_t hash);
+void persist_set_motor_hash(int idx, uint64_t hash);
+
+// Per-tick publish (simulation thread): bracket the stores with
+// begin/end so a restart can detect a torn crash image via seq
+void persist_begin(void);
+void persist_store_values(const double *values, int count);
+void persist_store_motor(int idx, double target, bool moving);
+void persist_end(void); // Throttled msync(MS_ASYNC)
+
+void persist_close(void); // Synchronous final flush; the file remains
+
+#endif // BEAMLINE_PERSIST_H
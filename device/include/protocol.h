@@ -7,17 +7,42 @@
 
 typedef enum {
     CMD_GET,
+    CMD_GETW,     // Binary waveform read
+    CMD_GETHIST,  // Binary history window read
+    CMD_SNAPSHOT, // Full preformatted name=value listing
     CMD_PUT,
     CMD_MOVE,
     CMD_STATUS,
     CMD_LIST,
     CMD_MONITOR,
+    CMD_SCAN,
     CMD_STOP,
     CMD_PING,
+    CMD_STATS,
     CMD_QUIT,
+    CMD_BINARY,   // Upgrade this connection to the binary protocol mode
     CMD_INVALID
 } cmd_type_t;
 
+// Binary protocol mode, negotiated on a live text connection with the
+// BINARY command: "OK:BINARY\n" is the last text line, and every
+// subsequent byte in both directions is length-prefixed frames (all
+// integers and doubles little-endian, raw IEEE-754):
+//   Request:  uint32 len | uint8 opcode | payload   (len counts opcode on)
+//   Response: uint32 len | uint8 opcode | uint8 status | payload
+// Opcodes are the cmd_type_t values; status 0 is success, otherwise
+// error_code_t + 1. PVs are addressed by the uint32 handles returned by
+// BIN_OP_RESOLVE (name bytes in, handle out), so the hot commands carry
+// no strings and parsing is a bounds check plus a memcpy:
+//   CMD_GET:  uint32 handle            -> double value
+//   CMD_PUT:  uint32 handle + double   -> (empty)
+//   CMD_MOVE: uint32 setpoint handle + double target -> (empty)
+//   CMD_PING / CMD_QUIT: (empty)       -> (empty)
+// Streaming and introspection commands stay on the text protocol; a
+// console keeps its human-debuggable connection alongside.
+#define BIN_OP_RESOLVE 0xFFu
+#define BEAMLINE_BIN_MAX_FRAME (BEAMLINE_PV_NAME_MAX + 16)
+
 typedef enum {
     ERR_UNKNOWN_CMD,
     ERR_UNKNOWN_PV,
@@ -26,16 +51,29 @@ typedef enum {
     ERR_INTERNAL
 } error_code_t;
 
+// Parsed command. Target strings are pointers into the caller's command
+// buffer (tokenized in place by protocol_parse); they are valid until the
+// buffer is reused, i.e. for the duration of command execution.
 typedef struct {
     cmd_type_t type;
-    char target[BEAMLINE_PV_NAME_MAX];
+    const char* target;  // First target (single-PV commands)
     double value;
     bool has_value;
     int monitor_interval_ms;  // For MONITOR command
+    double monitor_deadband;  // Minimum change to notify (0 = any change)
+    // Comma-separated target lists (multi-PV MONITOR, batched GET/PUT, SCAN)
+    const char* targets[BEAMLINE_MAX_CMD_TARGETS];
+    double values[BEAMLINE_MAX_CMD_TARGETS];  // Per-target values (batched PUT)
+    int target_count;
+    // SCAN trajectory (targets[0] = motor, targets[1..] = detectors)
+    double scan_start;
+    double scan_stop;
+    double scan_step;
 } cmd_t;
 
-// Command parsing
-bool protocol_parse(const char* input, cmd_t* cmd);
+// Command parsing. Tokenizes input in place: separators become NULs and
+// cmd carries pointers into the buffer, so no bytes are copied.
+bool protocol_parse(char* input, cmd_t* cmd);
 
 // Named parameters struct for protocol_format_error
 typedef struct {
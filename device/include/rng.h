@@ -0,0 +1,23 @@
+#ifndef BEAMLINE_RNG_H
+#define BEAMLINE_RNG_H
+
+#include <stdint.h>
+
+// xoshiro256++ pseudo-random stream (Blackman & Vigna). Each noise source
+// owns its own state, so streams are uncorrelated and lock-free, and a
+// fixed seed reproduces the exact same simulation for regression runs.
+// The batch fillers generate a whole vector at once so noise application
+// across PV arrays stays a tight, vectorizable loop.
+typedef struct {
+    uint64_t s[4];
+} rng_t;
+
+void rng_seed(rng_t* rng, uint64_t seed);  // splitmix64 state expansion
+uint64_t rng_next(rng_t* rng);             // Raw 64-bit output
+double rng_uniform(rng_t* rng);            // One double in [0, 1)
+
+// Batch generation: n samples into out
+void rng_fill_uniform(rng_t* rng, double* out, int n);   // [0, 1)
+void rng_fill_gaussian(rng_t* rng, double* out, int n);  // Standard normal
+
+#endif // BEAMLINE_RNG_H
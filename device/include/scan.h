@@ -0,0 +1,34 @@
+#ifndef BEAMLINE_SCAN_H
+#define BEAMLINE_SCAN_H
+
+#include <stdbool.h>
+#include "config.h"
+
+// Server-side fly-scan engine. A scan drives a motor through the existing
+// kinematics in devices_update() and streams timestamped
+// ROW:<time_ms>,<position>,<det1>,...  lines to the owning client as the
+// motor crosses each sample position, ending with OK:SCAN_DONE. One scan
+// per client slot; each slot's scan state is touched only by the worker
+// thread owning that slot, so service and any_active take a slot range.
+
+// Named parameters struct for scan_begin (C23 best practice)
+typedef struct {
+    int client_slot;  // Rows are delivered through server_send()
+    const char *motor_pv;  // Setpoint PV name of the motor to fly
+    const char *const *detector_pvs;
+    int detector_count;
+    double start;
+    double stop;
+    double step;  // Sampling pitch along the trajectory (> 0)
+} scan_begin_params_t;
+
+bool scan_begin(scan_begin_params_t params);
+// Advance active scans in [first_slot, first_slot + slot_count); call
+// once per loop iteration on the owning worker
+void scan_service(int first_slot, int slot_count);
+void scan_abort(int client_slot);
+bool scan_active(int client_slot);
+// Any scan in flight in the slot range (event-loop wakeup hint)
+bool scan_any_active(int first_slot, int slot_count);
+
+#endif // BEAMLINE_SCAN_H
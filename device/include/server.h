@@ -1,9 +1,21 @@
 #ifndef BEAMLINE_SERVER_H
 #define BEAMLINE_SERVER_H
 
-// Server initialization and control
-int server_init(void);  // Returns listen_fd
-void server_run_once(int listen_fd);  // One iteration of event loop
-void server_cleanup(int listen_fd);
+#include <stddef.h>
+
+// Server initialization and control. The server runs BEAMLINE_WORKERS
+// sharded event loops (default 1): each worker thread owns a contiguous
+// range of client slots, its own event context and its own SO_REUSEPORT
+// listener, so command execution scales with cores. server_init() spawns
+// workers 1..N-1; worker 0 is driven by the caller through
+// server_run_once().
+int server_init(void);  // Returns 0 on success
+void server_run_once(void);  // One iteration of worker 0's event loop
+void server_cleanup(void);
+
+// Queue data for a client through its buffered non-blocking send path
+// (used by subsystems like the scan engine that address clients by slot).
+// Must be called on the worker thread owning the slot.
+void server_send(int client_slot, const char* data, size_t len);
 
 #endif // BEAMLINE_SERVER_H
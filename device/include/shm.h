@@ -0,0 +1,45 @@
+#ifndef BEAMLINE_SHM_H
+#define BEAMLINE_SHM_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Shared-memory PV snapshot for co-located clients. The simulation
+// thread publishes every scalar value once per tick under a seqlock, so
+// a local analysis process can poll any PV at memory latency with zero
+// syscalls instead of a GET round-trip.
+//
+// Segment layout (BEAMLINE_SHM_NAME under /dev/shm):
+//   shm_snap_header_t
+//   uint64_t hash[count]   -- FNV-1a 64 of each PV name, registry order
+//   double   value[count]  -- values, same order
+//
+// Reader protocol: load seq (acquire); if odd, retry. Copy the values
+// of interest, re-load seq; if it changed, retry. Hashes are written
+// once before the first publish and never change.
+
+#define BEAMLINE_SHM_MAGIC 0x424C5356u // "BLSV"
+#define BEAMLINE_SHM_VERSION 1u
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t pad;
+    _Atomic uint64_t seq; // Seqlock: odd while the writer is mid-publish
+} shm_snap_header_t;
+
+// FNV-1a 64-bit hash of a PV name; readers use the same function to
+// locate their PV's slot in the hash table
+uint64_t shm_name_hash(const char *name);
+
+// Writer side (simulation process). shm_export_init() creates and maps
+// the segment; all calls are no-ops until it succeeds, so linking this
+// module never forces a segment into existence (tests, benches).
+bool shm_export_init(int count);
+void shm_export_set_hash(int idx, uint64_t hash);
+void shm_export_publish(const double *values, int count);
+void shm_export_close(void);
+
+#endif // BEAMLINE_SHM_H
@@ -0,0 +1,43 @@
+#ifndef BEAMLINE_STATS_H
+#define BEAMLINE_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "protocol.h"
+
+// Hot-path instrumentation: lock-free log2 latency histograms and byte
+// counters, cheap enough to stay on in production. Exposed through the
+// STATS protocol command so a stall can be attributed to parsing,
+// command execution, simulation, or the network without a profiler.
+
+typedef enum {
+    STAT_PARSE,     // protocol_parse()
+    STAT_TICK,      // devices_update() (simulation thread)
+    STAT_WAIT,      // event_wait() blocking phase
+    STAT_DISPATCH,  // Ready-fd dispatch + monitor/scan servicing
+    // One class per cmd_type_t, indexed STAT_EXEC_FIRST + type
+    STAT_EXEC_FIRST,
+    STAT_CLASS_COUNT = STAT_EXEC_FIRST + CMD_INVALID + 1
+} stats_class_t;
+
+void stats_init(void);  // Anchors the uptime counter
+uint64_t stats_now_ns(void);
+void stats_record(stats_class_t cls, uint64_t elapsed_ns);
+void stats_add_bytes_in(size_t n);
+void stats_add_bytes_out(size_t n);
+
+// Named parameters struct for stats_format (C23 best practice). The
+// caller supplies the gauges only the server can see.
+typedef struct {
+    char *buf;
+    size_t len;
+    int clients;
+    size_t sendq_bytes;  // Total bytes queued across client send buffers
+    int dirty_depth;     // Undrained monitor notifications
+} stats_format_params_t;
+
+// Format the STATS response payload: counters plus count/p50/p99 (µs)
+// per recorded class. Returns the payload length.
+size_t stats_format(stats_format_params_t params);
+
+#endif // BEAMLINE_STATS_H
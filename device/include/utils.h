@@ -4,8 +4,11 @@
 #include <stdbool.h>
 #include <stddef.h>
 
-// Logging
+// Logging. log_init() starts a background drain thread; log calls then
+// enqueue into a lock-free ring instead of writing stderr inline.
+// Before log_init() (tests, benches) they log synchronously.
 void log_init(void);
+void log_shutdown(void);  // Flush pending records and join the drain thread
 void log_info(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
 void log_warn(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
 void log_error(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
@@ -19,4 +22,12 @@ void *safe_realloc(void *ptr, size_t size);
 void trim(char *str);
 bool str_to_double(const char *str, double *out);
 
+// Fast double-to-ASCII with %.6g-style output (6 significant digits,
+// trailing zeros stripped, scientific notation outside [1e-4, 1e6)).
+// Purpose-built for the GET/DATA response paths, where printf-class
+// formatting dominates the profile. Writes directly into buf, always
+// NUL-terminates, and returns the number of characters written.
+#define FMT_DOUBLE_MAX 24  // Worst case: "-1.23457e-308" plus slack
+size_t fmt_double(char *buf, size_t len, double value);
+
 #endif // BEAMLINE_UTILS_H
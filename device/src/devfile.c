@@ -0,0 +1,217 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "devfile.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "devices.h"
+#include "utils.h"
+
+// Cursor over the mmap'd file; the buffer is not NUL-terminated, so all
+// scanning is length-bounded
+typedef struct {
+    const char *p;
+    const char *end;
+    int line;
+} devfile_cursor_t;
+
+// Helper: Skip spaces and tabs (not newlines)
+static void skip_blanks(devfile_cursor_t *cur) {
+    while (cur->p < cur->end && (*cur->p == ' ' || *cur->p == '\t')) {
+        cur->p++;
+    }
+}
+
+// Helper: Skip to the first character of the next line
+static void skip_line(devfile_cursor_t *cur) {
+    while (cur->p < cur->end && *cur->p != '\n') {
+        cur->p++;
+    }
+    if (cur->p < cur->end) {
+        cur->p++;
+    }
+    cur->line++;
+}
+
+// Helper: Read the next whitespace-delimited token on the current line
+// into buf. Returns false at end of line.
+static bool next_token(devfile_cursor_t *cur, char *buf, size_t buf_len) {
+    skip_blanks(cur);
+    if (cur->p >= cur->end || *cur->p == '\n' || *cur->p == '#') {
+        return false;
+    }
+
+    size_t len = 0;
+    while (cur->p < cur->end && *cur->p != ' ' && *cur->p != '\t' && *cur->p != '\n' &&
+           *cur->p != '\r') {
+        if (len + 1 < buf_len) {
+            buf[len++] = *cur->p;
+        }
+        cur->p++;
+    }
+    buf[len] = '\0';
+    return len > 0;
+}
+
+// Helper: Read the next token and convert it to a double
+static bool next_double(devfile_cursor_t *cur, double *out) {
+    char tok[64];
+    return next_token(cur, tok, sizeof(tok)) && str_to_double(tok, out);
+}
+
+// Helper: Map a type token to pv_type_t
+static bool parse_pv_type(const char *tok, pv_type_t *out) {
+    if (strcmp(tok, "ai") == 0) {
+        *out = PV_AI;
+    } else if (strcmp(tok, "ao") == 0) {
+        *out = PV_AO;
+    } else if (strcmp(tok, "bi") == 0) {
+        *out = PV_BI;
+    } else if (strcmp(tok, "bo") == 0) {
+        *out = PV_BO;
+    } else if (strcmp(tok, "wf") == 0) {
+        *out = PV_WAVEFORM;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Helper: Map an update-kind token to its registry tag
+static bool parse_update_kind(const char *tok, pv_update_kind_t *out) {
+    if (strcmp(tok, "none") == 0) {
+        *out = PV_UPDATE_NONE;
+    } else if (strcmp(tok, "noise") == 0) {
+        *out = PV_UPDATE_NOISE;
+    } else if (strcmp(tok, "walk") == 0) {
+        *out = PV_UPDATE_WALK;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Helper: Parse one "pv" directive (keyword already consumed)
+static bool parse_pv_line(devfile_cursor_t *cur) {
+    char name[BEAMLINE_PV_NAME_MAX];
+    char type_tok[16];
+    char update_tok[16];
+    pv_type_t type;
+    double min;
+    double max;
+    pv_update_kind_t kind;
+
+    if (!next_token(cur, name, sizeof(name)) || !next_token(cur, type_tok, sizeof(type_tok)) ||
+        !parse_pv_type(type_tok, &type) || !next_double(cur, &min) || !next_double(cur, &max) ||
+        !next_token(cur, update_tok, sizeof(update_tok)) ||
+        !parse_update_kind(update_tok, &kind)) {
+        return false;
+    }
+
+    double nelem_d = 0.0;
+    if (type == PV_WAVEFORM && !next_double(cur, &nelem_d)) {
+        return false;
+    }
+
+    bool writable = (type == PV_AO || type == PV_BO);
+    return pv_register((pv_register_params_t) {.name = name,
+                                               .type = type,
+                                               .range = {min, max},
+                                               .writable = writable,
+                                               .kind = kind,
+                                               .nelem = (int) nelem_d}) != NULL;
+}
+
+// Helper: Parse one "motor" directive (keyword already consumed)
+static bool parse_motor_line(devfile_cursor_t *cur) {
+    char name[BEAMLINE_PV_NAME_MAX];
+    double min;
+    double max;
+    double velocity;
+
+    if (!next_token(cur, name, sizeof(name)) || !next_double(cur, &min) ||
+        !next_double(cur, &max) || !next_double(cur, &velocity)) {
+        return false;
+    }
+
+    return motor_register((motor_register_params_t) {
+               .name = name, .range = {min, max}, .velocity = velocity}) != NULL;
+}
+
+bool devfile_load(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        log_error("Cannot open device file: %s", path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        log_error("Cannot stat device file (or empty): %s", path);
+        close(fd);
+        return false;
+    }
+
+    char *data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        log_error("Cannot mmap device file: %s", path);
+        return false;
+    }
+
+    devfile_cursor_t cur = {.p = data, .end = data + st.st_size, .line = 1};
+    bool have_counts = false;
+    bool ok = true;
+    int pv_lines = 0;
+    int motor_lines = 0;
+
+    while (cur.p < cur.end && ok) {
+        char keyword[16];
+        if (!next_token(&cur, keyword, sizeof(keyword))) {
+            skip_line(&cur); // Blank line or comment
+            continue;
+        }
+
+        if (strcmp(keyword, "counts") == 0) {
+            double pvs_d;
+            double motors_d;
+            if (have_counts || !next_double(&cur, &pvs_d) || !next_double(&cur, &motors_d)) {
+                ok = false;
+                break;
+            }
+            // Each motor expands to three PVs on top of the pv lines
+            ok = devices_prealloc((int) pvs_d + 3 * (int) motors_d, (int) motors_d);
+            have_counts = ok;
+        } else if (strcmp(keyword, "pv") == 0) {
+            ok = have_counts && parse_pv_line(&cur);
+            pv_lines++;
+        } else if (strcmp(keyword, "motor") == 0) {
+            ok = have_counts && parse_motor_line(&cur);
+            motor_lines++;
+        } else {
+            ok = false;
+        }
+
+        if (ok) {
+            skip_line(&cur);
+        }
+    }
+
+    int line = cur.line;
+    munmap(data, (size_t) st.st_size);
+
+    if (!ok || !have_counts) {
+        log_error("Device file parse failed at %s:%d", path, line);
+        return false;
+    }
+
+    log_info("Loaded %d PV and %d motor definitions from %s", pv_lines, motor_lines, path);
+    return true;
+}
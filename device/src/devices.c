@@ -1,168 +1,573 @@
 #include "devices.h"
 
 #include <math.h>
+#include <pthread.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
+#include "devfile.h"
+#include "persist.h"
+#include "rng.h"
+#include "shm.h"
+#include "stats.h"
 #include "utils.h"
 
-// Global registry
-static pv_t g_pvs[BEAMLINE_MAX_PVS];
+// Global registry, heap-allocated by devices_prealloc() so a device file
+// can size it for a full sector instead of the built-in BL02 set
+static pv_t *g_pvs = NULL;
+static int g_pv_max = 0;
 static int g_pv_count = 0;
-static motor_t g_motors[8]; // X, Y, Z, THETA, MONO:ENERGY, etc.
+static motor_t *g_motors = NULL;
+static int g_motor_max = 0;
 static int g_motor_count = 0;
 
-// Internal helper to register a PV (using named parameters struct)
-static pv_t *pv_register(pv_register_params_t params) {
-    if (g_pv_count >= BEAMLINE_MAX_PVS) {
+// Motor deadline queue. A move is analytic -- start position, velocity
+// and target fully determine the trajectory -- so each pending move sits
+// in a min-heap keyed by its computed arrival time on the simulation
+// clock. The tick loop touches only motors actually moving, positions
+// come from the closed form instead of velocity*dt integration, and the
+// readback lands exactly on target when the arrival deadline passes
+// rather than whenever a step happens to overshoot. Retargets bump the
+// motor's generation and push a fresh entry; the stale one is skipped
+// when it surfaces (lazy deletion), so the heap is sized for two
+// entries per motor and compacted if retargets ever fill it.
+typedef struct {
+    double start_pos; // Readback when the move was (re)targeted
+    double t_start;   // Simulation-clock time of the (re)target
+    double t_arrive;  // Analytic completion time
+    uint32_t gen;     // Bumped on every (re)target
+} motor_traj_t;
+
+typedef struct {
+    double t_arrive;
+    int idx;      // Motor index
+    uint32_t gen; // Trajectory generation at push time
+} move_ent_t;
+
+static motor_traj_t *g_traj = NULL;
+static move_ent_t *g_move_heap = NULL;
+static int g_move_heap_count = 0;
+static double g_sim_time = 0.0; // Accumulated dt (simulation thread)
+
+// Open-addressing hash index over g_pvs: slots hold registry index + 1
+// (0 = empty). Built incrementally in pv_register(); entries are never
+// removed, so linear probing needs no tombstones.
+static int *g_pv_index = NULL;
+static int g_pv_index_size = 0;
+
+// Sorted-name index: registry indices ordered by name, re-sorted lazily
+// on the first pv_list() after a registration (the count going stale is
+// the only invalidation, since PVs are never removed). Names are
+// hierarchical and clients list with trailing-star prefixes constantly,
+// so those resolve to a contiguous run here by binary search instead of
+// globbing the whole registry.
+static int *g_pv_sorted = NULL;
+static int g_pv_sorted_count = 0;
+
+// Worker topology: each worker owns a contiguous range of client slots;
+// the masks translate a PV's subscriber bits into the set of workers to
+// notify. Defaults to one worker owning every slot.
+static int g_worker_count = 1;
+static uint32_t g_worker_masks[BEAMLINE_MAX_WORKERS] = {0xffffffffu};
+
+// Dirty rings (SPSC, one per worker): the simulation thread appends PVs
+// whose value moved beyond the deadband onto the ring of every worker
+// whose shard subscribes; each worker drains only its own ring in
+// pv_take_dirty(). A PV is in flight at most once per worker, guarded by
+// its per-worker dirty bit. Capacity is a power of two so wrapping
+// uint32 indices stay valid.
+static int *g_dirty_rings[BEAMLINE_MAX_WORKERS];
+static uint32_t g_dirty_ring_mask = 0;
+static _Atomic uint32_t g_dirty_heads[BEAMLINE_MAX_WORKERS]; // Consumers (workers)
+static _Atomic uint32_t g_dirty_tails[BEAMLINE_MAX_WORKERS]; // Producer (simulation thread)
+
+// Struct-of-arrays hot state: the per-tick sweep reads and writes only
+// these dense arrays, never the cold pv_t records, so 50k value updates
+// stream through cache instead of striding past 64-byte names.
+static double *g_values = NULL;  // Live values (simulation thread)
+static double *g_mins = NULL;    // Clamp bounds, fixed at registration
+static double *g_maxs = NULL;
+static uint8_t *g_kinds = NULL;  // pv_update_kind_t per PV
+static rng_t *g_rngs = NULL;     // Per-PV noise streams
+
+// SNAPSHOT cache: the full name=value listing, rebuilt at most once per
+// published tick on first demand. The lock is held from pv_snapshot_text
+// to pv_snapshot_release so one worker's rebuild cannot overwrite the
+// bytes another worker is still copying out.
+static char *g_snapshot_text = NULL;
+static size_t g_snapshot_text_len = 0;
+static uint32_t g_snapshot_text_seq = 0;
+static pthread_mutex_t g_snapshot_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Seqlock-published value snapshot: written once per tick by the
+// simulation thread, read lock-free by the network thread
+static _Atomic uint32_t g_snap_seq = 0;
+static double *g_snap_values = NULL;
+
+// Waveform element storage: live buffers (simulation thread) are carved
+// from g_wave_pool at registration; g_wave_snap mirrors the pool under
+// the same seqlock so pv_read_wave() sees tick-consistent arrays.
+static double g_wave_pool[BEAMLINE_WAVEFORM_POOL_ELEMENTS];
+static double g_wave_snap[BEAMLINE_WAVEFORM_POOL_ELEMENTS];
+static int g_wave_pool_used = 0;
+
+// History sample storage: per-PV rings carved from a shared pool at
+// registration. The simulation thread writes a slot and then publishes
+// the PV's hist_head with release order, so pv_read_hist never sees a
+// half-written sample.
+static pv_hist_sample_t g_hist_pool[BEAMLINE_HISTORY_POOL_SAMPLES];
+static int g_hist_pool_used = 0;
+
+// Write mailbox (MPSC): worker threads validate and enqueue PUT and MOVE
+// requests; the simulation thread applies them at the next tick so all
+// device-state mutation stays on one thread. Cells carry a sequence
+// number (same scheme as the log ring in utils.c) so concurrent
+// producers never publish a half-written request.
+typedef struct {
+    _Atomic uint32_t seq; // pos when free, pos + 1 when full
+    bool is_move;
+    int idx;  // PV index (PUT) or motor index (MOVE)
+    double value;
+} device_req_t;
+
+#define DEVICE_REQ_QUEUE_SIZE 256
+static device_req_t g_req_queue[DEVICE_REQ_QUEUE_SIZE];
+static _Atomic uint32_t g_req_head = 0; // Consumer (simulation thread)
+static _Atomic uint32_t g_req_tail = 0; // Producers (worker threads)
+
+static void devices_publish(void);
+static void update_wave_noise(pv_t *pv);
+static void pv_sorted_rebuild(void);
+
+// Helper: Live value slot for a PV (simulation thread writes; other
+// threads read through the snapshot via pv_read)
+static double *pv_slot(pv_t *pv) {
+    return &g_values[pv - g_pvs];
+}
+
+// Base seed for per-PV noise streams: BEAMLINE_RNG_SEED makes runs
+// reproducible, otherwise the wall clock varies them. Set before any
+// registration so every PV's stream derives from it.
+static uint64_t g_rng_base_seed = 0;
+
+// Handles to dependency PVs, resolved once at the end of devices_init()
+// so update functions don't pay a lookup per 10 ms tick.
+static pv_handle_t g_h_ring_current = PV_HANDLE_INVALID;
+static pv_handle_t g_h_shutter_cmd = PV_HANDLE_INVALID;
+static pv_handle_t g_h_mono_energy = PV_HANDLE_INVALID;
+static pv_handle_t g_h_mono_energy_rbv = PV_HANDLE_INVALID;
+
+// FNV-1a string hash
+static uint32_t pv_hash(const char *name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *) name; *p != '\0'; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Helper: Insert a registered PV into the hash index
+static void pv_index_insert(int pv_idx) {
+    uint32_t slot = pv_hash(g_pvs[pv_idx].name) % (uint32_t) g_pv_index_size;
+    while (g_pv_index[slot] != 0) {
+        slot = (slot + 1) % (uint32_t) g_pv_index_size;
+    }
+    g_pv_index[slot] = pv_idx + 1;
+}
+
+bool devices_prealloc(int max_pvs, int max_motors) {
+    if (max_pvs < 1 || max_motors < 0) {
+        return false;
+    }
+
+    free(g_pvs);
+    free(g_motors);
+    free(g_traj);
+    free(g_move_heap);
+    free(g_pv_index);
+    free(g_pv_sorted);
+    for (int w = 0; w < BEAMLINE_MAX_WORKERS; w++) {
+        free(g_dirty_rings[w]);
+        g_dirty_rings[w] = NULL;
+    }
+    free(g_snap_values);
+    free(g_values);
+    free(g_mins);
+    free(g_maxs);
+    free(g_kinds);
+    free(g_rngs);
+    free(g_snapshot_text);
+    g_snapshot_text = NULL;
+    g_snapshot_text_len = 0;
+
+    // Index sized for < 50% load factor; dirty ring rounded up to a
+    // power of two
+    int index_size = max_pvs * 4;
+    uint32_t ring_size = 1;
+    while (ring_size < (uint32_t) max_pvs) {
+        ring_size <<= 1;
+    }
+
+    g_pvs = calloc((size_t) max_pvs, sizeof(pv_t));
+    g_motors = (max_motors > 0) ? calloc((size_t) max_motors, sizeof(motor_t)) : NULL;
+    g_traj = (max_motors > 0) ? calloc((size_t) max_motors, sizeof(motor_traj_t)) : NULL;
+    g_move_heap =
+        (max_motors > 0) ? calloc((size_t) max_motors * 2, sizeof(move_ent_t)) : NULL;
+    g_pv_index = calloc((size_t) index_size, sizeof(int));
+    g_pv_sorted = calloc((size_t) max_pvs, sizeof(int));
+    bool rings_ok = true;
+    for (int w = 0; w < BEAMLINE_MAX_WORKERS; w++) {
+        g_dirty_rings[w] = calloc(ring_size, sizeof(int));
+        rings_ok = rings_ok && g_dirty_rings[w] != NULL;
+    }
+    g_snap_values = calloc((size_t) max_pvs, sizeof(double));
+    g_values = calloc((size_t) max_pvs, sizeof(double));
+    g_mins = calloc((size_t) max_pvs, sizeof(double));
+    g_maxs = calloc((size_t) max_pvs, sizeof(double));
+    g_kinds = calloc((size_t) max_pvs, sizeof(uint8_t));
+    g_rngs = calloc((size_t) max_pvs, sizeof(rng_t));
+
+    if (g_pvs == NULL ||
+        (max_motors > 0 && (g_motors == NULL || g_traj == NULL || g_move_heap == NULL)) ||
+        g_pv_index == NULL ||
+        g_pv_sorted == NULL || !rings_ok || g_snap_values == NULL || g_values == NULL ||
+        g_mins == NULL || g_maxs == NULL || g_kinds == NULL || g_rngs == NULL) {
+        log_error("Out of memory preallocating %d PVs, %d motors", max_pvs, max_motors);
+        return false;
+    }
+
+    g_pv_max = max_pvs;
+    g_motor_max = max_motors;
+    g_pv_count = 0;
+    g_motor_count = 0;
+    g_move_heap_count = 0;
+    g_sim_time = 0.0;
+    g_pv_index_size = index_size;
+    g_pv_sorted_count = 0;
+    g_dirty_ring_mask = ring_size - 1;
+    for (int w = 0; w < BEAMLINE_MAX_WORKERS; w++) {
+        g_dirty_heads[w] = 0;
+        g_dirty_tails[w] = 0;
+    }
+    g_req_head = 0;
+    g_req_tail = 0;
+    for (uint32_t i = 0; i < DEVICE_REQ_QUEUE_SIZE; i++) {
+        atomic_store_explicit(&g_req_queue[i].seq, i, memory_order_relaxed);
+    }
+    g_wave_pool_used = 0;
+    g_hist_pool_used = 0;
+    return true;
+}
+
+pv_t *pv_register(pv_register_params_t params) {
+    if (g_pv_count >= g_pv_max) {
         log_error("PV registry full, cannot register: %s", params.name);
         return NULL;
     }
 
-    pv_t *pv = &g_pvs[g_pv_count++];
+    if (params.nelem > 0) {
+        if (params.nelem > BEAMLINE_WAVEFORM_MAX_ELEMENTS ||
+            params.nelem > BEAMLINE_WAVEFORM_POOL_ELEMENTS - g_wave_pool_used) {
+            log_error("Waveform pool exhausted, cannot register: %s", params.name);
+            return NULL;
+        }
+    }
+    if (params.hist_depth > 0) {
+        if (params.hist_depth > BEAMLINE_HISTORY_MAX_SAMPLES ||
+            params.hist_depth > BEAMLINE_HISTORY_POOL_SAMPLES - g_hist_pool_used) {
+            log_error("History pool exhausted, cannot register: %s", params.name);
+            return NULL;
+        }
+    }
+
+    // Waveform noise needs the element buffer, so it runs as a callback
+    // rather than in the dense scalar sweep
+    pv_update_kind_t kind = params.kind;
+    void (*update_fn)(pv_t *) = params.update_fn;
+    if (update_fn != NULL) {
+        kind = PV_UPDATE_CUSTOM;
+    } else if (kind == PV_UPDATE_NOISE && params.nelem > 0) {
+        kind = PV_UPDATE_CUSTOM;
+        update_fn = update_wave_noise;
+    }
+
+    int idx = g_pv_count++;
+    pv_t *pv = &g_pvs[idx];
     strncpy(pv->name, params.name, BEAMLINE_PV_NAME_MAX - 1);
     pv->name[BEAMLINE_PV_NAME_MAX - 1] = '\0';
     pv->type = params.type;
-    pv->value = 0.0;
     pv->min = params.range.min;
     pv->max = params.range.max;
     pv->writable = params.writable;
-    pv->update_fn = params.update_fn;
+    pv->update_fn = update_fn;
+    g_values[idx] = 0.0;
+    g_mins[idx] = params.range.min;
+    g_maxs[idx] = params.range.max;
+    g_kinds[idx] = (uint8_t) kind;
+    pv->subscribers = 0;
+    pv->deadband = 0.0;
+    pv->notified_value = 0.0;
+    pv->dirty = 0;
+    pv->elements = NULL;
+    pv->nelem = 0;
+    if (params.nelem > 0) {
+        pv->elements = &g_wave_pool[g_wave_pool_used];
+        pv->nelem = params.nelem;
+        memset(pv->elements, 0, (size_t) params.nelem * sizeof(double));
+        g_wave_pool_used += params.nelem;
+    }
+    pv->hist = NULL;
+    pv->hist_depth = 0;
+    pv->hist_head = 0;
+    rng_seed(&g_rngs[idx], g_rng_base_seed + (uint64_t) idx);
+    if (params.hist_depth > 0) {
+        pv->hist = &g_hist_pool[g_hist_pool_used];
+        pv->hist_depth = params.hist_depth;
+        g_hist_pool_used += params.hist_depth;
+    }
+
+    pv_index_insert(idx);
 
     return pv;
 }
 
+motor_t *motor_register(motor_register_params_t params) {
+    if (g_motor_count >= g_motor_max) {
+        log_error("Motor registry full, cannot register: %s", params.name);
+        return NULL;
+    }
+
+    size_t name_len = strlen(params.name);
+    if (name_len + 6 > BEAMLINE_PV_NAME_MAX) { // Room for ".DMOV\0"
+        log_error("Motor name too long: %s", params.name);
+        return NULL;
+    }
+
+    motor_t *motor = &g_motors[g_motor_count];
+    motor->setpoint = pv_register((pv_register_params_t) {.name = params.name,
+                                                          .type = PV_AO,
+                                                          .range = {params.range.min,
+                                                                    params.range.max},
+                                                          .writable = true,
+                                                          .update_fn = NULL});
+
+    char derived[BEAMLINE_PV_NAME_MAX];
+    memcpy(derived, params.name, name_len);
+    memcpy(derived + name_len, ".RBV", 5);
+    motor->readback = pv_register((pv_register_params_t) {.name = derived,
+                                                          .type = PV_AI,
+                                                          .range = {params.range.min,
+                                                                    params.range.max},
+                                                          .writable = false,
+                                                          .update_fn = NULL});
+
+    memcpy(derived + name_len, ".DMOV", 6);
+    motor->status_pv = pv_register((pv_register_params_t) {.name = derived,
+                                                           .type = PV_BI,
+                                                           .range = {0, 1},
+                                                           .writable = false,
+                                                           .update_fn = NULL});
+
+    if (motor->setpoint == NULL || motor->readback == NULL || motor->status_pv == NULL) {
+        return NULL;
+    }
+
+    motor->velocity = params.velocity;
+    motor->accel = 0.0; // Not used in linear interpolation
+    motor->target = 0.0;
+    motor->moving = false;
+    g_motor_count++;
+    return motor;
+}
+
 // Sensor update functions
 static void update_ring_current(pv_t *pv) {
-    double noise = (rand() / (double) RAND_MAX - 0.5) * 4.0;
-    pv->value = 350.0 + noise;
-    if (pv->value < 0) {
-        pv->value = 0;
+    double noise = (rng_uniform(&g_rngs[pv - g_pvs]) - 0.5) * 4.0;
+    double v = 350.0 + noise;
+    if (v < 0) {
+        v = 0;
     }
-    if (pv->value > 400) {
-        pv->value = 400;
+    if (v > 400) {
+        v = 400;
     }
+    *pv_slot(pv) = v;
 }
 
 static void update_vacuum(pv_t *pv) {
     // Log-scale: log10(pressure) with noise
-    double log_p = -8.3 + ((rand() / (double) RAND_MAX - 0.5) * 0.2);
-    pv->value = pow(10, log_p);
+    double log_p = -8.3 + ((rng_uniform(&g_rngs[pv - g_pvs]) - 0.5) * 0.2);
+    double v = pow(10, log_p);
     // Clamp to range
-    if (pv->value < 1e-10) {
-        pv->value = 1e-10;
+    if (v < 1e-10) {
+        v = 1e-10;
     }
-    if (pv->value > 1e-8) {
-        pv->value = 1e-8;
+    if (v > 1e-8) {
+        v = 1e-8;
     }
+    *pv_slot(pv) = v;
 }
 
 static void update_temp(pv_t *pv) {
     // Slow drift
     static double drift = 0.0;
-    drift += (rand() / (double) RAND_MAX - 0.5) * 0.01;
-    pv->value = 23.0 + drift;
+    drift += (rng_uniform(&g_rngs[pv - g_pvs]) - 0.5) * 0.01;
+    double v = 23.0 + drift;
     // Clamp
-    if (pv->value < 20) {
-        pv->value = 20;
+    if (v < 20) {
+        v = 20;
     }
-    if (pv->value > 26) {
-        pv->value = 26;
+    if (v > 26) {
+        v = 26;
     }
+    *pv_slot(pv) = v;
 }
 
 static void update_detector_i0(pv_t *pv) {
     // Proportional to ring current
-    pv_t *ring_current = pv_find("BL02:RING:CURRENT");
+    pv_t *ring_current = pv_from_handle(g_h_ring_current);
     if (!ring_current) {
         return;
     }
 
-    double factor = ring_current->value / 350.0; // Normalize
+    double factor = *pv_slot(ring_current) / 350.0; // Normalize
     double base = 500000.0;
-    double noise = (rand() / (double) RAND_MAX - 0.5) * 10000.0;
-    pv->value = (base * factor) + noise;
+    double noise = (rng_uniform(&g_rngs[pv - g_pvs]) - 0.5) * 10000.0;
+    double v = (base * factor) + noise;
 
-    if (pv->value < 0) {
-        pv->value = 0;
+    if (v < 0) {
+        v = 0;
     }
-    if (pv->value > 1e6) {
-        pv->value = 1e6;
+    if (v > 1e6) {
+        v = 1e6;
     }
+    *pv_slot(pv) = v;
 }
 
 static void update_detector_it(pv_t *pv) {
     // Similar to I0 but different base
-    pv_t *ring_current = pv_find("BL02:RING:CURRENT");
+    pv_t *ring_current = pv_from_handle(g_h_ring_current);
     if (!ring_current) {
         return;
     }
 
-    double factor = ring_current->value / 350.0;
+    double factor = *pv_slot(ring_current) / 350.0;
     double base = 450000.0;
-    double noise = (rand() / (double) RAND_MAX - 0.5) * 10000.0;
-    pv->value = (base * factor) + noise;
+    double noise = (rng_uniform(&g_rngs[pv - g_pvs]) - 0.5) * 10000.0;
+    double v = (base * factor) + noise;
 
-    if (pv->value < 0) {
-        pv->value = 0;
+    if (v < 0) {
+        v = 0;
     }
-    if (pv->value > 1e6) {
-        pv->value = 1e6;
+    if (v > 1e6) {
+        v = 1e6;
     }
+    *pv_slot(pv) = v;
 }
 
 static void update_detector_if(pv_t *pv) {
     // Fluorescence detector
-    pv_t *ring_current = pv_find("BL02:RING:CURRENT");
+    pv_t *ring_current = pv_from_handle(g_h_ring_current);
     if (!ring_current) {
         return;
     }
 
-    double factor = ring_current->value / 350.0;
+    double factor = *pv_slot(ring_current) / 350.0;
     double base = 50000.0;
-    double noise = (rand() / (double) RAND_MAX - 0.5) * 1000.0;
-    pv->value = (base * factor) + noise;
+    double noise = (rng_uniform(&g_rngs[pv - g_pvs]) - 0.5) * 1000.0;
+    double v = (base * factor) + noise;
 
-    if (pv->value < 0) {
-        pv->value = 0;
+    if (v < 0) {
+        v = 0;
     }
-    if (pv->value > 1e5) {
-        pv->value = 1e5;
+    if (v > 1e5) {
+        v = 1e5;
     }
+    *pv_slot(pv) = v;
+}
+
+static void update_mca(pv_t *pv) {
+    // Fluorescence spectrum: a Gaussian peak whose channel tracks the
+    // monochromator energy, scaled by ring current, over a flat background
+    pv_t *ring_current = pv_from_handle(g_h_ring_current);
+    pv_t *energy_rbv = pv_from_handle(g_h_mono_energy_rbv);
+    if (ring_current == NULL || energy_rbv == NULL) {
+        return;
+    }
+
+    double factor = *pv_slot(ring_current) / 350.0;
+    double peak_ch = (*pv_slot(energy_rbv) - 4000.0) / (20000.0 - 4000.0) * pv->nelem;
+    double sigma = 30.0; // Channels
+    double amplitude = 1000.0 * factor;
+
+    // One batched draw per tick; the shaping loop stays branch-light
+    static double noise[BEAMLINE_WAVEFORM_MAX_ELEMENTS];
+    rng_fill_uniform(&g_rngs[pv - g_pvs], noise, pv->nelem);
+
+    double total = 0.0;
+    for (int i = 0; i < pv->nelem; i++) {
+        double d = (i - peak_ch) / sigma;
+        double counts = amplitude * exp(-0.5 * d * d) + 10.0;
+        counts += (noise[i] - 0.5) * 2.0 * sqrt(counts);
+        if (counts < 0) {
+            counts = 0;
+        }
+        pv->elements[i] = counts;
+        total += counts;
+    }
+    *pv_slot(pv) = total; // Scalar GET reports integrated counts
 }
 
 static void update_shutter_status(pv_t *pv) {
     // Status follows command
-    pv_t *cmd = pv_find("BL02:SHUTTER:CMD");
+    pv_t *cmd = pv_from_handle(g_h_shutter_cmd);
     if (cmd) {
-        pv->value = cmd->value; // Simplified: instant response
+        *pv_slot(pv) = *pv_slot(cmd); // Simplified: instant response
     }
 }
 
-// Public functions
-void devices_init(void) {
-    g_pv_count = 0;
-    g_motor_count = 0;
+// Helper: Generic waveform noise (file-defined wf PVs): batch the raw
+// draws into the element buffer, shape in a second pass, integrate
+static void update_wave_noise(pv_t *pv) {
+    ptrdiff_t idx = pv - g_pvs;
+    double mid = 0.5 * (g_mins[idx] + g_maxs[idx]);
+    double amp = (g_maxs[idx] - g_mins[idx]) * 0.01;
+
+    rng_fill_uniform(&g_rngs[idx], pv->elements, pv->nelem);
+    double total = 0.0;
+    for (int i = 0; i < pv->nelem; i++) {
+        pv->elements[i] = mid + (pv->elements[i] - 0.5) * amp;
+        total += pv->elements[i];
+    }
+    g_values[idx] = total;
+}
 
-    // Register sensors (read-only)
+// Helper: Register the built-in BL02 device set
+static void register_builtin_devices(void) {
+    // Register sensors (read-only). The environment sensors keep ~10 s of
+    // tick history so excursions can be reconstructed after the fact.
     pv_register((pv_register_params_t) {.name = "BL02:RING:CURRENT",
                                         .type = PV_AI,
                                         .range = {0, 400},
                                         .writable = false,
-                                        .update_fn = update_ring_current});
+                                        .update_fn = update_ring_current,
+                                        .hist_depth = 1024});
     pv_register((pv_register_params_t) {.name = "BL02:VACUUM:PRESSURE",
                                         .type = PV_AI,
                                         .range = {1e-10, 1e-8},
                                         .writable = false,
-                                        .update_fn = update_vacuum});
+                                        .update_fn = update_vacuum,
+                                        .hist_depth = 1024});
     pv_register((pv_register_params_t) {.name = "BL02:HUTCH:TEMP",
                                         .type = PV_AI,
                                         .range = {20, 26},
                                         .writable = false,
-                                        .update_fn = update_temp});
+                                        .update_fn = update_temp,
+                                        .hist_depth = 1024});
     pv_register((pv_register_params_t) {.name = "BL02:DET:I0",
                                         .type = PV_AI,
                                         .range = {0, 1e6},
@@ -179,6 +584,14 @@ void devices_init(void) {
                                         .writable = false,
                                         .update_fn = update_detector_if});
 
+    // Register MCA spectrum (waveform)
+    pv_register((pv_register_params_t) {.name = "BL02:DET:MCA",
+                                        .type = PV_WAVEFORM,
+                                        .range = {0, 1e9},
+                                        .writable = false,
+                                        .update_fn = update_mca,
+                                        .nelem = BEAMLINE_WAVEFORM_MAX_ELEMENTS});
+
     // Register shutter
     pv_register((pv_register_params_t) {.name = "BL02:SHUTTER:STATUS",
                                         .type = PV_BI,
@@ -192,191 +605,668 @@ void devices_init(void) {
                                         .update_fn = NULL});
 
     // Register motors
-    // Sample stage X
-    motor_t *motor_x = &g_motors[g_motor_count++];
-    motor_x->setpoint = pv_register((pv_register_params_t) {.name = "BL02:SAMPLE:X",
-                                                            .type = PV_AO,
-                                                            .range = {-10000, 10000},
-                                                            .writable = true,
-                                                            .update_fn = NULL});
-    motor_x->readback = pv_register((pv_register_params_t) {.name = "BL02:SAMPLE:X.RBV",
-                                                            .type = PV_AI,
-                                                            .range = {-10000, 10000},
-                                                            .writable = false,
-                                                            .update_fn = NULL});
-    motor_x->status_pv = pv_register((pv_register_params_t) {.name = "BL02:SAMPLE:X.DMOV",
-                                                             .type = PV_BI,
-                                                             .range = {0, 1},
-                                                             .writable = false,
-                                                             .update_fn = NULL});
-    motor_x->velocity = 1000.0; // μm/s
-    motor_x->accel = 0.0;       // Not used in linear interpolation
-    motor_x->target = 0.0;
-    motor_x->moving = false;
-
-    // Sample stage Y
-    motor_t *motor_y = &g_motors[g_motor_count++];
-    motor_y->setpoint = pv_register((pv_register_params_t) {.name = "BL02:SAMPLE:Y",
-                                                            .type = PV_AO,
-                                                            .range = {-10000, 10000},
-                                                            .writable = true,
-                                                            .update_fn = NULL});
-    motor_y->readback = pv_register((pv_register_params_t) {.name = "BL02:SAMPLE:Y.RBV",
-                                                            .type = PV_AI,
-                                                            .range = {-10000, 10000},
-                                                            .writable = false,
-                                                            .update_fn = NULL});
-    motor_y->status_pv = pv_register((pv_register_params_t) {.name = "BL02:SAMPLE:Y.DMOV",
-                                                             .type = PV_BI,
-                                                             .range = {0, 1},
-                                                             .writable = false,
-                                                             .update_fn = NULL});
-    motor_y->velocity = 1000.0;
-    motor_y->accel = 0.0;
-    motor_y->target = 0.0;
-    motor_y->moving = false;
-
-    // Sample stage Z
-    motor_t *motor_z = &g_motors[g_motor_count++];
-    motor_z->setpoint = pv_register((pv_register_params_t) {.name = "BL02:SAMPLE:Z",
-                                                            .type = PV_AO,
-                                                            .range = {-5000, 5000},
-                                                            .writable = true,
-                                                            .update_fn = NULL});
-    motor_z->readback = pv_register((pv_register_params_t) {.name = "BL02:SAMPLE:Z.RBV",
-                                                            .type = PV_AI,
-                                                            .range = {-5000, 5000},
-                                                            .writable = false,
-                                                            .update_fn = NULL});
-    motor_z->status_pv = pv_register((pv_register_params_t) {.name = "BL02:SAMPLE:Z.DMOV",
-                                                             .type = PV_BI,
-                                                             .range = {0, 1},
-                                                             .writable = false,
-                                                             .update_fn = NULL});
-    motor_z->velocity = 1000.0;
-    motor_z->accel = 0.0;
-    motor_z->target = 0.0;
-    motor_z->moving = false;
-
-    // Sample stage THETA
-    motor_t *motor_theta = &g_motors[g_motor_count++];
-    motor_theta->setpoint = pv_register((pv_register_params_t) {.name = "BL02:SAMPLE:THETA",
-                                                                .type = PV_AO,
-                                                                .range = {-180, 180},
-                                                                .writable = true,
-                                                                .update_fn = NULL});
-    motor_theta->readback = pv_register((pv_register_params_t) {.name = "BL02:SAMPLE:THETA.RBV",
-                                                                .type = PV_AI,
-                                                                .range = {-180, 180},
-                                                                .writable = false,
-                                                                .update_fn = NULL});
-    motor_theta->status_pv = pv_register((pv_register_params_t) {.name = "BL02:SAMPLE:THETA.DMOV",
-                                                                 .type = PV_BI,
-                                                                 .range = {0, 1},
-                                                                 .writable = false,
-                                                                 .update_fn = NULL});
-    motor_theta->velocity = 10.0; // deg/s
-    motor_theta->accel = 0.0;
-    motor_theta->target = 0.0;
-    motor_theta->moving = false;
-
-    // Monochromator energy
-    motor_t *motor_energy = &g_motors[g_motor_count++];
-    motor_energy->setpoint = pv_register((pv_register_params_t) {.name = "BL02:MONO:ENERGY",
-                                                                 .type = PV_AO,
-                                                                 .range = {4000, 20000},
-                                                                 .writable = true,
-                                                                 .update_fn = NULL});
-    motor_energy->readback = pv_register((pv_register_params_t) {.name = "BL02:MONO:ENERGY.RBV",
-                                                                 .type = PV_AI,
-                                                                 .range = {4000, 20000},
-                                                                 .writable = false,
-                                                                 .update_fn = NULL});
-    motor_energy->status_pv = pv_register((pv_register_params_t) {.name = "BL02:MONO:ENERGY.DMOV",
-                                                                  .type = PV_BI,
-                                                                  .range = {0, 1},
-                                                                  .writable = false,
-                                                                  .update_fn = NULL});
-    motor_energy->velocity = 100.0; // eV/s
-    motor_energy->accel = 0.0;
-    motor_energy->target = 8000.0; // Default energy
-    motor_energy->moving = false;
-    motor_energy->readback->value = 8000.0; // Initialize readback
-
-    // Initialize random seed
-    srand((unsigned int) time(NULL));
+    motor_register((motor_register_params_t) {
+        .name = "BL02:SAMPLE:X", .range = {-10000, 10000}, .velocity = 1000.0}); // μm/s
+    motor_register((motor_register_params_t) {
+        .name = "BL02:SAMPLE:Y", .range = {-10000, 10000}, .velocity = 1000.0});
+    motor_register((motor_register_params_t) {
+        .name = "BL02:SAMPLE:Z", .range = {-5000, 5000}, .velocity = 1000.0});
+    motor_register((motor_register_params_t) {
+        .name = "BL02:SAMPLE:THETA", .range = {-180, 180}, .velocity = 10.0}); // deg/s
+
+    // Monochromator energy, parked at a default energy
+    motor_t *motor_energy = motor_register((motor_register_params_t) {
+        .name = "BL02:MONO:ENERGY", .range = {4000, 20000}, .velocity = 100.0}); // eV/s
+    if (motor_energy != NULL) {
+        motor_energy->target = 8000.0;
+        *pv_slot(motor_energy->readback) = 8000.0;
+    }
+}
+
+// Public functions
+void devices_init(void) {
+    // Resolve the noise base seed before any PV registers a stream
+    const char *seed_env = getenv("BEAMLINE_RNG_SEED");
+    g_rng_base_seed = (seed_env != NULL && seed_env[0] != '\0')
+                          ? strtoull(seed_env, NULL, 0)
+                          : (uint64_t) time(NULL);
+
+    bool loaded = false;
+    const char *device_file = getenv("BEAMLINE_DEVICE_FILE");
+    if (device_file != NULL && device_file[0] != '\0') {
+        loaded = devfile_load(device_file);
+        if (!loaded) {
+            log_warn("Device file rejected, falling back to built-in devices");
+        }
+    }
+
+    if (!loaded) {
+        if (!devices_prealloc(BEAMLINE_MAX_PVS, BEAMLINE_MAX_MOTORS)) {
+            return;
+        }
+        register_builtin_devices();
+    }
+
+    // Resolve dependency handles once for the hot update paths (invalid
+    // when a device file replaces the built-in set; update_fns check)
+    g_h_ring_current = pv_handle("BL02:RING:CURRENT");
+    g_h_shutter_cmd = pv_handle("BL02:SHUTTER:CMD");
+    g_h_mono_energy = pv_handle("BL02:MONO:ENERGY");
+    g_h_mono_energy_rbv = pv_handle("BL02:MONO:ENERGY.RBV");
+
+    // Publish initial values so snapshot readers see them before the
+    // first tick, and sort the name index now so no rebuild races a
+    // worker's pv_list() once the server threads start
+    devices_publish();
+    pv_sorted_rebuild();
 
     log_info("Initialized %d process variables, %d motors", g_pv_count, g_motor_count);
 }
 
-static void motor_update(motor_t *motor, double dt) {
-    if (motor == NULL || !motor->moving) {
-        return;
+// Helper: Sift a move entry up/down to restore the min-heap invariant
+static void move_heap_up(int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (g_move_heap[parent].t_arrive <= g_move_heap[i].t_arrive) {
+            break;
+        }
+        move_ent_t tmp = g_move_heap[parent];
+        g_move_heap[parent] = g_move_heap[i];
+        g_move_heap[i] = tmp;
+        i = parent;
+    }
+}
+
+static void move_heap_down(int i) {
+    for (;;) {
+        int left = 2 * i + 1;
+        int right = left + 1;
+        int least = i;
+        if (left < g_move_heap_count &&
+            g_move_heap[left].t_arrive < g_move_heap[least].t_arrive) {
+            least = left;
+        }
+        if (right < g_move_heap_count &&
+            g_move_heap[right].t_arrive < g_move_heap[least].t_arrive) {
+            least = right;
+        }
+        if (least == i) {
+            break;
+        }
+        move_ent_t tmp = g_move_heap[least];
+        g_move_heap[least] = g_move_heap[i];
+        g_move_heap[i] = tmp;
+        i = least;
     }
+}
 
-    double current = motor->readback->value;
-    double diff = motor->target - current;
+// Helper: Drop stale entries and re-heapify (only needed if retargets
+// arrive faster than their superseded deadlines expire)
+static void move_heap_compact(void) {
+    int kept = 0;
+    for (int i = 0; i < g_move_heap_count; i++) {
+        move_ent_t *ent = &g_move_heap[i];
+        if (ent->gen == g_traj[ent->idx].gen && g_motors[ent->idx].moving) {
+            g_move_heap[kept++] = *ent;
+        }
+    }
+    g_move_heap_count = kept;
+    for (int i = kept / 2 - 1; i >= 0; i--) {
+        move_heap_down(i);
+    }
+}
+
+static void move_heap_push(double t_arrive, int idx, uint32_t gen) {
+    if (g_move_heap_count >= g_motor_max * 2) {
+        move_heap_compact(); // At most one live entry per motor remains
+    }
+    g_move_heap[g_move_heap_count] =
+        (move_ent_t) {.t_arrive = t_arrive, .idx = idx, .gen = gen};
+    move_heap_up(g_move_heap_count);
+    g_move_heap_count++;
+}
 
-    if (fabs(diff) < 0.001) {
-        // Reached target
+// Helper: Service the motor deadline queue (simulation thread). Arrived
+// moves pop in deadline order and land exactly on target; in-flight
+// moves take their closed-form position. Idle motors are never visited.
+static void motor_service(void) {
+    while (g_move_heap_count > 0 && g_move_heap[0].t_arrive <= g_sim_time) {
+        move_ent_t ent = g_move_heap[0];
+        g_move_heap[0] = g_move_heap[--g_move_heap_count];
+        move_heap_down(0);
+
+        motor_t *motor = &g_motors[ent.idx];
+        if (ent.gen != g_traj[ent.idx].gen || !motor->moving) {
+            continue; // Superseded by a retarget
+        }
+        *pv_slot(motor->readback) = motor->target;
         motor->moving = false;
-        motor->readback->value = motor->target;
         if (motor->status_pv) {
-            motor->status_pv->value = 0.0; // IDLE
+            *pv_slot(motor->status_pv) = 0.0; // IDLE
         }
-        return;
     }
 
-    // Linear interpolation (simplified)
-    double rate = motor->velocity;
-    double step = rate * dt;
+    for (int i = 0; i < g_move_heap_count; i++) {
+        move_ent_t *ent = &g_move_heap[i];
+        motor_t *motor = &g_motors[ent->idx];
+        motor_traj_t *traj = &g_traj[ent->idx];
+        if (ent->gen != traj->gen || !motor->moving) {
+            continue;
+        }
+        double dir = (motor->target >= traj->start_pos) ? 1.0 : -1.0;
+        *pv_slot(motor->readback) =
+            traj->start_pos + dir * motor->velocity * (g_sim_time - traj->t_start);
+    }
+}
 
-    if (fabs(diff) < step) {
-        motor->readback->value = motor->target;
-        motor->moving = false;
-        if (motor->status_pv) {
-            motor->status_pv->value = 0.0;
+// Helper: Mark subscribed PVs dirty when they changed beyond the deadband
+// (simulation thread). A change fans out to the dirty ring of every
+// worker whose shard subscribes and that has no notification in flight.
+static void check_dirty(void) {
+    for (int i = 0; i < g_pv_count; i++) {
+        pv_t *pv = &g_pvs[i];
+        uint32_t subs = pv->subscribers;
+        if (subs == 0) {
+            continue;
         }
-    } else {
-        motor->readback->value += (diff > 0 ? step : -step);
-        if (motor->status_pv) {
-            motor->status_pv->value = 1.0; // MOVING
+        if (fabs(g_values[i] - pv->notified_value) <= pv->deadband) {
+            continue;
         }
+
+        uint8_t want = 0;
+        for (int w = 0; w < g_worker_count; w++) {
+            if ((subs & g_worker_masks[w]) != 0 && (pv->dirty & (uint8_t) (1u << w)) == 0) {
+                want |= (uint8_t) (1u << w);
+            }
+        }
+        if (want == 0) {
+            continue;
+        }
+
+        // All target rings must have room, else retry the PV next tick
+        // (notified_value stays put so the change is not forgotten)
+        uint32_t tails[BEAMLINE_MAX_WORKERS] = {0};
+        bool room = true;
+        for (int w = 0; w < g_worker_count; w++) {
+            if ((want & (uint8_t) (1u << w)) == 0) {
+                continue;
+            }
+            tails[w] = atomic_load_explicit(&g_dirty_tails[w], memory_order_relaxed);
+            uint32_t head = atomic_load_explicit(&g_dirty_heads[w], memory_order_acquire);
+            if (tails[w] - head > g_dirty_ring_mask) {
+                room = false;
+            }
+        }
+        if (!room) {
+            continue;
+        }
+
+        pv->dirty |= want;
+        pv->notified_value = g_values[i];
+        for (int w = 0; w < g_worker_count; w++) {
+            if ((want & (uint8_t) (1u << w)) == 0) {
+                continue;
+            }
+            g_dirty_rings[w][tails[w] & g_dirty_ring_mask] = i;
+            atomic_store_explicit(&g_dirty_tails[w], tails[w] + 1, memory_order_release);
+        }
+    }
+}
+
+// Helper: Apply queued PUT/MOVE requests from the worker threads. Cells
+// whose sequence has not been published yet end the drain; they will be
+// picked up next tick.
+static void apply_requests(void) {
+    uint32_t head = atomic_load_explicit(&g_req_head, memory_order_relaxed);
+    for (;;) {
+        device_req_t *req = &g_req_queue[head % DEVICE_REQ_QUEUE_SIZE];
+        uint32_t seq = atomic_load_explicit(&req->seq, memory_order_acquire);
+        if ((int32_t) (seq - (head + 1)) != 0) {
+            break; // Empty, or a producer is mid-write
+        }
+        if (req->is_move) {
+            motor_move(g_motors[req->idx].setpoint->name, req->value);
+        } else {
+            pv_set(&g_pvs[req->idx], req->value);
+        }
+        atomic_store_explicit(&req->seq, head + DEVICE_REQ_QUEUE_SIZE, memory_order_release);
+        head++;
+    }
+    atomic_store_explicit(&g_req_head, head, memory_order_release);
+}
+
+// Helper: Append one (time, value) sample to every history ring
+// (simulation thread). The slot is written before hist_head is
+// published, so readers only ever see complete samples.
+static void archive_history(void) {
+    double t_ms = (double) (stats_now_ns() / 1000000ull);
+    for (int i = 0; i < g_pv_count; i++) {
+        pv_t *pv = &g_pvs[i];
+        if (pv->hist_depth == 0) {
+            continue;
+        }
+        uint64_t head = atomic_load_explicit(&pv->hist_head, memory_order_relaxed);
+        pv->hist[head % (uint64_t) pv->hist_depth] =
+            (pv_hist_sample_t) {.t_ms = t_ms, .value = g_values[i]};
+        atomic_store_explicit(&pv->hist_head, head + 1, memory_order_release);
     }
 }
 
+// Helper: Publish all values to the seqlock snapshot (simulation thread)
+static void devices_publish(void) {
+    uint32_t seq = atomic_load_explicit(&g_snap_seq, memory_order_relaxed);
+    atomic_store_explicit(&g_snap_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(g_snap_values, g_values, (size_t) g_pv_count * sizeof(double));
+    memcpy(g_wave_snap, g_wave_pool, (size_t) g_wave_pool_used * sizeof(double));
+    atomic_store_explicit(&g_snap_seq, seq + 2, memory_order_release);
+
+    // Mirror scalars into the shared-memory export for co-located
+    // clients (no-op unless devices_shm_export() mapped the segment)
+    shm_export_publish(g_values, g_pv_count);
+
+    // Mirror into the persistent state file for warm restarts (no-op
+    // unless devices_state_attach() mapped it)
+    persist_begin();
+    persist_store_values(g_values, g_pv_count);
+    for (int i = 0; i < g_motor_count; i++) {
+        persist_store_motor(i, g_motors[i].target, g_motors[i].moving);
+    }
+    persist_end();
+}
+
+bool devices_shm_export(void) {
+    if (!shm_export_init(g_pv_count)) {
+        return false;
+    }
+    for (int i = 0; i < g_pv_count; i++) {
+        shm_export_set_hash(i, shm_name_hash(g_pvs[i].name));
+    }
+    shm_export_publish(g_values, g_pv_count);
+    log_info("Exported %d PVs to shared memory (%s)", g_pv_count, BEAMLINE_SHM_NAME);
+    return true;
+}
+
+bool devices_state_attach(void) {
+    const char *path = getenv("BEAMLINE_STATE_FILE");
+    if (path == NULL || path[0] == '\0') {
+        return false;
+    }
+    if (!persist_open(path, g_pv_count, g_motor_count)) {
+        return false;
+    }
+
+    // Overlay saved values onto stateful PVs: setpoints and anything
+    // else the sweep doesn't regenerate every tick. Noise/walk/custom
+    // PVs are simulation outputs, so restoring them is pointless.
+    int restored = 0;
+    if (persist_loaded()) {
+        for (int i = 0; i < g_pv_count; i++) {
+            pv_t *pv = &g_pvs[i];
+            if (g_kinds[i] != PV_UPDATE_NONE && !pv->writable) {
+                continue;
+            }
+            double value;
+            if (!persist_lookup_pv(shm_name_hash(pv->name), &value)) {
+                continue;
+            }
+            if (!isfinite(value) || value < pv->min || value > pv->max) {
+                continue; // Stale file or edited ranges: keep the default
+            }
+            g_values[i] = value;
+            pv->notified_value = value;
+            restored++;
+        }
+        // A motor that was mid-move resumes its travel from the
+        // restored readback position
+        for (int i = 0; i < g_motor_count; i++) {
+            motor_t *motor = &g_motors[i];
+            double target;
+            bool moving;
+            if (!persist_lookup_motor(shm_name_hash(motor->setpoint->name),
+                                      &target, &moving)) {
+                continue;
+            }
+            if (!isfinite(target) || target < motor->setpoint->min ||
+                target > motor->setpoint->max) {
+                continue;
+            }
+            if (moving) {
+                // Re-arm through motor_move so the deadline queue picks
+                // the travel up from the restored readback position
+                motor_move(motor->setpoint->name, target);
+            } else {
+                motor->target = target;
+            }
+        }
+        log_info("Restored %d PVs from state file %s", restored, path);
+    }
+
+    for (int i = 0; i < g_pv_count; i++) {
+        persist_set_pv_hash(i, shm_name_hash(g_pvs[i].name));
+    }
+    for (int i = 0; i < g_motor_count; i++) {
+        persist_set_motor_hash(i, shm_name_hash(g_motors[i].setpoint->name));
+    }
+    // Republish so snapshot readers (and the file itself) see the warm
+    // values before the first tick
+    devices_publish();
+    return true;
+}
+
 void devices_update(double dt) {
-    // Update all PVs with update functions
+    uint64_t t_tick = stats_now_ns();
+    g_sim_time += dt;
+    apply_requests();
+
+    // Kind-tagged sweep over the dense arrays: the generic noise and
+    // walk kinds (what a 50k-PV device file registers) touch only
+    // contiguous doubles and rng state; bespoke callbacks are the
+    // handful of built-in sensors.
     for (int i = 0; i < g_pv_count; i++) {
-        if (g_pvs[i].update_fn != NULL) {
+        switch (g_kinds[i]) {
+        case PV_UPDATE_NOISE: {
+            double mid = 0.5 * (g_mins[i] + g_maxs[i]);
+            double amp = (g_maxs[i] - g_mins[i]) * 0.01;
+            g_values[i] = mid + (rng_uniform(&g_rngs[i]) - 0.5) * amp;
+            break;
+        }
+        case PV_UPDATE_WALK: {
+            double step = (g_maxs[i] - g_mins[i]) * 0.001;
+            double v = g_values[i] + (rng_uniform(&g_rngs[i]) - 0.5) * step;
+            g_values[i] = v < g_mins[i] ? g_mins[i] : (v > g_maxs[i] ? g_maxs[i] : v);
+            break;
+        }
+        case PV_UPDATE_CUSTOM:
             g_pvs[i].update_fn(&g_pvs[i]);
+            break;
+        default:
+            break;
         }
     }
 
-    // Update motors
-    for (int i = 0; i < g_motor_count; i++) {
-        motor_update(&g_motors[i], dt);
+    motor_service();
+
+    archive_history();
+    check_dirty();
+    devices_publish();
+    stats_record(STAT_TICK, stats_now_ns() - t_tick);
+}
+
+void devices_set_workers(int count) {
+    if (count < 1) {
+        count = 1;
+    }
+    if (count > BEAMLINE_MAX_WORKERS) {
+        count = BEAMLINE_MAX_WORKERS;
+    }
+    g_worker_count = count;
+
+    int per = BEAMLINE_MAX_CLIENTS / count;
+    for (int w = 0; w < count; w++) {
+        int first = w * per;
+        int last = (w == count - 1) ? BEAMLINE_MAX_CLIENTS : first + per;
+        uint32_t mask = 0;
+        for (int s = first; s < last; s++) {
+            mask |= (uint32_t) 1 << s;
+        }
+        g_worker_masks[w] = mask;
+    }
+}
+
+void pv_subscribe(pv_t *pv, int slot, double deadband) {
+    if (pv == NULL || slot < 0 || slot >= BEAMLINE_MAX_CLIENTS) {
+        return;
+    }
+    pv->deadband = deadband;
+    pv->subscribers |= (uint32_t) 1 << slot;
+}
+
+void pv_unsubscribe_all(int slot) {
+    if (slot < 0 || slot >= BEAMLINE_MAX_CLIENTS) {
+        return;
+    }
+    for (int i = 0; i < g_pv_count; i++) {
+        g_pvs[i].subscribers &= ~((uint32_t) 1 << slot);
+    }
+}
+
+int pv_take_dirty(int worker, pv_t **out, int max) {
+    if (worker < 0 || worker >= g_worker_count) {
+        return 0;
     }
+    int count = 0;
+    uint32_t head = atomic_load_explicit(&g_dirty_heads[worker], memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&g_dirty_tails[worker], memory_order_acquire);
+    while (head != tail && count < max) {
+        pv_t *pv = &g_pvs[g_dirty_rings[worker][head & g_dirty_ring_mask]];
+        pv->dirty &= (uint8_t) ~(1u << worker);
+        if (pv->subscribers != 0) {
+            out[count++] = pv;
+        }
+        head++;
+    }
+    atomic_store_explicit(&g_dirty_heads[worker], head, memory_order_release);
+    return count;
+}
+
+int pv_dirty_depth(int worker) {
+    if (worker < 0 || worker >= g_worker_count) {
+        return 0;
+    }
+    uint32_t head = atomic_load_explicit(&g_dirty_heads[worker], memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&g_dirty_tails[worker], memory_order_relaxed);
+    return (int) (tail - head);
+}
+
+double pv_read(const pv_t *pv) {
+    if (pv == NULL) {
+        return 0.0;
+    }
+
+    ptrdiff_t idx = pv - g_pvs;
+    if (idx < 0 || idx >= g_pv_count) {
+        return 0.0;
+    }
+
+    uint32_t s1;
+    uint32_t s2;
+    double value;
+    do {
+        s1 = atomic_load_explicit(&g_snap_seq, memory_order_acquire);
+        value = g_snap_values[idx];
+        atomic_thread_fence(memory_order_acquire);
+        s2 = atomic_load_explicit(&g_snap_seq, memory_order_relaxed);
+    } while (s1 != s2 || (s1 & 1) != 0);
+
+    return value;
+}
+
+int pv_read_wave(const pv_t *pv, double *out, int max) {
+    if (pv == NULL || out == NULL || pv->nelem == 0) {
+        return 0;
+    }
+
+    int count = pv->nelem < max ? pv->nelem : max;
+    ptrdiff_t off = pv->elements - g_wave_pool;
+    if (off < 0 || off + count > g_wave_pool_used) {
+        return 0;
+    }
+
+    uint32_t s1;
+    uint32_t s2;
+    do {
+        s1 = atomic_load_explicit(&g_snap_seq, memory_order_acquire);
+        memcpy(out, g_wave_snap + off, (size_t) count * sizeof(double));
+        atomic_thread_fence(memory_order_acquire);
+        s2 = atomic_load_explicit(&g_snap_seq, memory_order_relaxed);
+    } while (s1 != s2 || (s1 & 1) != 0);
+
+    return count;
+}
+
+int pv_read_hist(const pv_t *pv, pv_hist_sample_t *out, int max) {
+    if (pv == NULL || out == NULL || pv->hist_depth == 0 || max <= 0) {
+        return 0;
+    }
+
+    uint64_t depth = (uint64_t) pv->hist_depth;
+    uint64_t head = atomic_load_explicit(&pv->hist_head, memory_order_acquire);
+    uint64_t n = ((uint64_t) max < depth) ? (uint64_t) max : depth;
+    if (n > head) {
+        n = head;
+    }
+    uint64_t first = head - n;
+    for (uint64_t i = 0; i < n; i++) {
+        out[i] = pv->hist[(first + i) % depth];
+    }
+
+    // The simulation thread may have lapped the oldest copied slots while
+    // we read: sample i is torn once the writer reaches i + depth, and it
+    // can be one sample past the republished head mid-write. Trim the
+    // front down to the provably untouched suffix.
+    uint64_t head2 = atomic_load_explicit(&pv->hist_head, memory_order_acquire);
+    uint64_t safe_first = (head2 + 1 > depth) ? head2 + 1 - depth : 0;
+    if (safe_first > first) {
+        uint64_t drop = safe_first - first;
+        if (drop >= n) {
+            return 0;
+        }
+        memmove(out, out + drop, (size_t) (n - drop) * sizeof(out[0]));
+        n -= drop;
+    }
+    return (int) n;
+}
+
+size_t pv_snapshot_text(const char **out, int *count) {
+    // The lock is taken even on the empty path so callers can pair every
+    // call with pv_snapshot_release() unconditionally
+    pthread_mutex_lock(&g_snapshot_lock);
+    if (out == NULL || g_pv_count == 0) {
+        return 0;
+    }
+
+    uint32_t seq = atomic_load_explicit(&g_snap_seq, memory_order_acquire);
+    if (g_snapshot_text == NULL) {
+        size_t cap = (size_t) g_pv_count * (BEAMLINE_PV_NAME_MAX + FMT_DOUBLE_MAX + 2) + 1;
+        g_snapshot_text = safe_malloc(cap);
+        g_snapshot_text_len = 0;
+    }
+
+    // Rebuild at most once per published tick; every SNAPSHOT served
+    // inside the same tick is a plain buffer write
+    if (g_snapshot_text_len == 0 || g_snapshot_text_seq != seq) {
+        size_t pos = 0;
+        for (int i = 0; i < g_pv_count; i++) {
+            const pv_t *pv = &g_pvs[i];
+            size_t name_len = strlen(pv->name);
+            memcpy(g_snapshot_text + pos, pv->name, name_len);
+            pos += name_len;
+            g_snapshot_text[pos++] = '=';
+            pos += fmt_double(g_snapshot_text + pos, FMT_DOUBLE_MAX, pv_read(pv));
+            g_snapshot_text[pos++] = '\n';
+        }
+        g_snapshot_text_len = pos;
+        g_snapshot_text_seq = seq;
+    }
+
+    *out = g_snapshot_text;
+    if (count != NULL) {
+        *count = g_pv_count;
+    }
+    return g_snapshot_text_len;
+}
+
+void pv_snapshot_release(void) {
+    pthread_mutex_unlock(&g_snapshot_lock);
+}
+
+// Helper: Claim a mailbox cell, fill it and publish it (any worker
+// thread). Returns false when the queue is full.
+static bool request_enqueue(bool is_move, int idx, double value) {
+    uint32_t tail = atomic_load_explicit(&g_req_tail, memory_order_relaxed);
+    for (;;) {
+        device_req_t *cell = &g_req_queue[tail % DEVICE_REQ_QUEUE_SIZE];
+        uint32_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        int32_t dif = (int32_t) (seq - tail);
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&g_req_tail, &tail, tail + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                cell->is_move = is_move;
+                cell->idx = idx;
+                cell->value = value;
+                atomic_store_explicit(&cell->seq, tail + 1, memory_order_release);
+                return true;
+            }
+        } else if (dif < 0) {
+            return false; // Full
+        } else {
+            tail = atomic_load_explicit(&g_req_tail, memory_order_relaxed);
+        }
+    }
+}
+
+bool devices_request_put(pv_t *pv, double value) {
+    if (pv == NULL || !pv->writable || value < pv->min || value > pv->max) {
+        return false;
+    }
+
+    if (!request_enqueue(false, (int) (pv - g_pvs), value)) {
+        log_warn("Device request queue full, dropping PUT %s", pv->name);
+        return false;
+    }
+    return true;
+}
+
+bool devices_request_move(const char *motor_name, double target) {
+    motor_t *motor = motor_find(motor_name);
+    if (motor == NULL || motor->setpoint == NULL) {
+        return false;
+    }
+    if (target < motor->setpoint->min || target > motor->setpoint->max) {
+        return false;
+    }
+
+    if (!request_enqueue(true, (int) (motor - g_motors), target)) {
+        log_warn("Device request queue full, dropping MOVE %s", motor_name);
+        return false;
+    }
+    return true;
 }
 
 pv_t *pv_find(const char *name) {
+    return pv_from_handle(pv_handle(name));
+}
+
+pv_handle_t pv_handle(const char *name) {
     if (name == NULL) {
-        return NULL;
+        return PV_HANDLE_INVALID;
     }
 
-    for (int i = 0; i < g_pv_count; i++) {
-        if (strcmp(g_pvs[i].name, name) == 0) {
-            return &g_pvs[i];
+    uint32_t slot = pv_hash(name) % (uint32_t) g_pv_index_size;
+    while (g_pv_index[slot] != 0) {
+        int pv_idx = g_pv_index[slot] - 1;
+        if (strcmp(g_pvs[pv_idx].name, name) == 0) {
+            return pv_idx;
         }
+        slot = (slot + 1) % (uint32_t) g_pv_index_size;
     }
-    return NULL;
+    return PV_HANDLE_INVALID;
+}
+
+pv_t *pv_from_handle(pv_handle_t handle) {
+    if (handle < 0 || handle >= g_pv_count) {
+        return NULL;
+    }
+    return &g_pvs[handle];
 }
 
 double pv_get(pv_t *pv) {
     if (pv == NULL) {
         return 0.0;
     }
-    return pv->value;
+    return g_values[pv - g_pvs];
 }
 
 bool pv_set(pv_t *pv, double value) {
@@ -390,13 +1280,13 @@ bool pv_set(pv_t *pv, double value) {
         return false;
     }
 
-    pv->value = value;
+    *pv_slot(pv) = value;
 
     // For monochromator, update readback immediately (will be motor in Phase 2.2)
-    if (strcmp(pv->name, "BL02:MONO:ENERGY") == 0) {
-        pv_t *rbv = pv_find("BL02:MONO:ENERGY.RBV");
+    if (pv == pv_from_handle(g_h_mono_energy)) {
+        pv_t *rbv = pv_from_handle(g_h_mono_energy_rbv);
         if (rbv) {
-            rbv->value = value;
+            *pv_slot(rbv) = value;
         }
     }
 
@@ -437,6 +1327,54 @@ static bool pattern_match(pattern_match_params_t params) {
     return *s == '\0'; // Must match entire string
 }
 
+// Helper: strcmp over registry indices for the sorted-name index
+static int pv_sorted_cmp(const void *a, const void *b) {
+    return strcmp(g_pvs[*(const int *) a].name, g_pvs[*(const int *) b].name);
+}
+
+// Helper: re-sort the name index if registrations happened since last use
+static void pv_sorted_rebuild(void) {
+    if (g_pv_sorted_count == g_pv_count) {
+        return;
+    }
+    for (int i = 0; i < g_pv_count; i++) {
+        g_pv_sorted[i] = i;
+    }
+    qsort(g_pv_sorted, (size_t) g_pv_count, sizeof(int), pv_sorted_cmp);
+    g_pv_sorted_count = g_pv_count;
+}
+
+// Helper: first sorted position whose name sorts >= the prefix
+static int pv_sorted_lower_bound(const char *prefix, size_t prefix_len) {
+    int lo = 0;
+    int hi = g_pv_sorted_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (strncmp(g_pvs[g_pv_sorted[mid]].name, prefix, prefix_len) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Helper: append one name to the comma-separated listing; false when full
+static bool list_append(char *buf, size_t len, size_t *pos, const char *name) {
+    size_t name_len = strlen(name);
+    size_t need = name_len + (*pos > 0 ? 1 : 0);
+    if (*pos + need >= len) {
+        return false;
+    }
+    if (*pos > 0) {
+        buf[(*pos)++] = ',';
+    }
+    memcpy(buf + *pos, name, name_len);
+    *pos += name_len;
+    buf[*pos] = '\0';
+    return true;
+}
+
 int pv_list(const char *pattern, char *buf, size_t len) {
     if (buf == NULL || len == 0) {
         return 0;
@@ -446,26 +1384,45 @@ int pv_list(const char *pattern, char *buf, size_t len) {
     int count = 0;
     size_t pos = 0;
 
+    size_t plen = (pattern != NULL) ? strlen(pattern) : 0;
+    const char *star = (plen > 0) ? strchr(pattern, '*') : NULL;
+
+    // A single trailing '*' is a prefix query: the matches are one
+    // contiguous run of the sorted index, found by binary search
+    if (star != NULL && star == pattern + plen - 1) {
+        pv_sorted_rebuild();
+        size_t prefix_len = plen - 1;
+        for (int s = pv_sorted_lower_bound(pattern, prefix_len); s < g_pv_sorted_count; s++) {
+            const char *name = g_pvs[g_pv_sorted[s]].name;
+            if (strncmp(name, pattern, prefix_len) != 0) {
+                break;
+            }
+            if (!list_append(buf, len, &pos, name)) {
+                break;
+            }
+            count++;
+        }
+        return count;
+    }
+
+    // No wildcard at all: a single hash lookup settles it
+    if (star == NULL && plen > 0) {
+        pv_t *pv = pv_find(pattern);
+        if (pv != NULL && list_append(buf, len, &pos, pv->name)) {
+            count = 1;
+        }
+        return count;
+    }
+
+    // Mid-string wildcards (and the match-all empty pattern) keep the
+    // glob sweep over the registry
     for (int i = 0; i < g_pv_count; i++) {
         const char *name = g_pvs[i].name;
-
         if (pattern_match((pattern_match_params_t) {.pattern = pattern, .str = name})) {
-            size_t name_len = strlen(name);
-            if (pos > 0) {
-                if (pos + 1 < len) {
-                    buf[pos++] = ',';
-                } else {
-                    break;
-                }
-            }
-            if (pos + name_len < len) {
-                strncpy(buf + pos, name, len - pos - 1);
-                pos += name_len;
-                buf[pos] = '\0';
-                count++;
-            } else {
+            if (!list_append(buf, len, &pos, name)) {
                 break;
             }
+            count++;
         }
     }
 
@@ -501,15 +1458,33 @@ bool motor_move(const char *motor_name, double target) {
     }
 
     motor->target = target;
-    motor->setpoint->value = target;
+    *pv_slot(motor->setpoint) = target;
     motor->moving = true;
     if (motor->status_pv) {
-        motor->status_pv->value = 1.0; // MOVING
+        *pv_slot(motor->status_pv) = 1.0; // MOVING
     }
 
+    // Schedule the analytic arrival; a zero-velocity motor lands at once
+    int idx = (int) (motor - g_motors);
+    motor_traj_t *traj = &g_traj[idx];
+    traj->start_pos = *pv_slot(motor->readback);
+    traj->t_start = g_sim_time;
+    traj->t_arrive = (motor->velocity > 0.0)
+                         ? g_sim_time + fabs(target - traj->start_pos) / motor->velocity
+                         : g_sim_time;
+    traj->gen++;
+    move_heap_push(traj->t_arrive, idx, traj->gen);
+
     return true;
 }
 
+uint32_t motor_move_generation(const motor_t *motor) {
+    if (motor == NULL) {
+        return 0;
+    }
+    return g_traj[motor - g_motors].gen;
+}
+
 const char *motor_get_status_string(motor_t *motor) {
     if (motor == NULL) {
         return "UNKNOWN";
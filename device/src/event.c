@@ -0,0 +1,630 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+// syscall() and MAP_POPULATE for the raw io_uring backend
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include "event.h"
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#define BEAMLINE_HAVE_EPOLL 1
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define BEAMLINE_HAVE_IO_URING 1
+#endif
+#endif
+#endif
+
+#include "config.h"
+#include "utils.h"
+
+static event_backend_t g_backend = EVENT_BACKEND_SELECT;
+
+#ifdef BEAMLINE_HAVE_IO_URING
+#ifndef IORING_POLL_ADD_MULTI
+#define IORING_POLL_ADD_MULTI (1U << 0) // Older uapi headers
+#endif
+
+#define URING_ENTRIES 64
+#define URING_TAG_CTL (1ull << 63) // Marks cancel CQEs, not poll reports
+
+// Registered fds: needed to re-arm a poll that the kernel retired
+typedef struct {
+    int fd;
+    bool want_write;
+    bool active;
+} uring_fd_t;
+#endif // BEAMLINE_HAVE_IO_URING
+
+// Per-loop backend state: one instance per worker thread, drawn from a
+// static pool so contexts need no allocation. Only the fields of the
+// backend chosen in event_init() are used.
+struct event_ctx {
+    bool in_use;
+
+    // select() backend: registered fds, rebuilt into fd_sets per wait
+    int select_fds[BEAMLINE_MAX_CLIENTS + 3];
+    bool select_want_write[BEAMLINE_MAX_CLIENTS + 3];
+    int select_count;
+
+    // epoll backend
+    int epoll_fd;
+
+#ifdef BEAMLINE_HAVE_IO_URING
+    // io_uring backend: ring fd, mappings and ring pointers
+    int ring_fd;
+    void *ring_mem;
+    size_t ring_mem_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    uint32_t sq_entries;
+    _Atomic uint32_t *sq_head;
+    _Atomic uint32_t *sq_tail;
+    uint32_t sq_mask;
+    uint32_t *sq_array;
+    uint32_t sq_pending; // Slots claimed via uring_get_sqe but not yet published
+    _Atomic uint32_t *cq_head;
+    _Atomic uint32_t *cq_tail;
+    uint32_t cq_mask;
+    struct io_uring_cqe *cqes;
+    uring_fd_t uring_fds[BEAMLINE_MAX_CLIENTS + 3];
+#endif
+};
+
+static struct event_ctx g_ctx_pool[BEAMLINE_MAX_WORKERS];
+
+static int select_add_fd(event_ctx_t *ctx, int fd) {
+    if (ctx->select_count >= (int) (sizeof(ctx->select_fds) / sizeof(ctx->select_fds[0]))) {
+        return -1;
+    }
+    ctx->select_want_write[ctx->select_count] = false;
+    ctx->select_fds[ctx->select_count++] = fd;
+    return 0;
+}
+
+static int select_del_fd(event_ctx_t *ctx, int fd) {
+    for (int i = 0; i < ctx->select_count; i++) {
+        if (ctx->select_fds[i] == fd) {
+            ctx->select_count--;
+            ctx->select_fds[i] = ctx->select_fds[ctx->select_count];
+            ctx->select_want_write[i] = ctx->select_want_write[ctx->select_count];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int select_mod_fd(event_ctx_t *ctx, int fd, bool want_write) {
+    for (int i = 0; i < ctx->select_count; i++) {
+        if (ctx->select_fds[i] == fd) {
+            ctx->select_want_write[i] = want_write;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int select_wait(event_ctx_t *ctx, int timeout_ms, event_ready_t *ready, int max_ready) {
+    fd_set read_fds;
+    fd_set write_fds;
+    FD_ZERO(&read_fds);
+    FD_ZERO(&write_fds);
+    int max_fd = -1;
+    for (int i = 0; i < ctx->select_count; i++) {
+        FD_SET(ctx->select_fds[i], &read_fds);
+        if (ctx->select_want_write[i]) {
+            FD_SET(ctx->select_fds[i], &write_fds);
+        }
+        if (ctx->select_fds[i] > max_fd) {
+            max_fd = ctx->select_fds[i];
+        }
+    }
+
+    // A negative timeout means block indefinitely (NULL timeval)
+    struct timeval timeout = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (long) (timeout_ms % 1000) * 1000L,
+    };
+
+    int nready = select(max_fd + 1, &read_fds, &write_fds, NULL,
+                        timeout_ms < 0 ? NULL : &timeout);
+    if (nready <= 0) {
+        return nready;
+    }
+
+    int count = 0;
+    for (int i = 0; i < ctx->select_count && count < max_ready; i++) {
+        bool readable = FD_ISSET(ctx->select_fds[i], &read_fds);
+        bool writable = FD_ISSET(ctx->select_fds[i], &write_fds);
+        if (readable || writable) {
+            ready[count++] = (event_ready_t) {
+                .fd = ctx->select_fds[i], .readable = readable, .writable = writable};
+        }
+    }
+    return count;
+}
+
+#ifdef BEAMLINE_HAVE_EPOLL
+static int epoll_backend_init(event_ctx_t *ctx) {
+    ctx->epoll_fd = epoll_create1(0);
+    if (ctx->epoll_fd < 0) {
+        log_error("epoll_create1() failed: %s", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static int epoll_add_fd(event_ctx_t *ctx, int fd) {
+    struct epoll_event ev = {.events = EPOLLIN, .data = {.fd = fd}};
+    if (epoll_ctl(ctx->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        log_error("epoll_ctl(ADD, fd=%d) failed: %s", fd, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static int epoll_del_fd(event_ctx_t *ctx, int fd) {
+    if (epoll_ctl(ctx->epoll_fd, EPOLL_CTL_DEL, fd, NULL) < 0) {
+        log_error("epoll_ctl(DEL, fd=%d) failed: %s", fd, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static int epoll_mod_fd(event_ctx_t *ctx, int fd, bool want_write) {
+    struct epoll_event ev = {.events = EPOLLIN | (want_write ? EPOLLOUT : 0),
+                             .data = {.fd = fd}};
+    if (epoll_ctl(ctx->epoll_fd, EPOLL_CTL_MOD, fd, &ev) < 0) {
+        log_error("epoll_ctl(MOD, fd=%d) failed: %s", fd, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static int epoll_wait_ready(event_ctx_t *ctx, int timeout_ms, event_ready_t *ready,
+                            int max_ready) {
+    struct epoll_event events[BEAMLINE_MAX_CLIENTS + 3];
+    int max_events = (int) (sizeof(events) / sizeof(events[0]));
+    if (max_ready < max_events) {
+        max_events = max_ready;
+    }
+
+    int nready = epoll_wait(ctx->epoll_fd, events, max_events, timeout_ms);
+    if (nready <= 0) {
+        return nready;
+    }
+
+    for (int i = 0; i < nready; i++) {
+        // Treat error/hangup as readable so the recv path sees the EOF
+        ready[i] = (event_ready_t) {
+            .fd = events[i].data.fd,
+            .readable = (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0,
+            .writable = (events[i].events & EPOLLOUT) != 0,
+        };
+    }
+    return nready;
+}
+#endif // BEAMLINE_HAVE_EPOLL
+
+#ifdef BEAMLINE_HAVE_IO_URING
+// io_uring backend (no liburing dependency: the rings are mapped and
+// driven through raw syscalls). One multishot IORING_OP_POLL_ADD stays
+// armed per registered fd, so a loop iteration costs at most one
+// io_uring_enter for the wait and zero syscalls when completions are
+// already queued; registration ops submit immediately, like epoll_ctl.
+
+static int sys_io_uring_setup(unsigned entries, struct io_uring_params *params) {
+    return (int) syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int sys_io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete,
+                              unsigned flags, const void *arg, size_t argsz) {
+    return (int) syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, arg,
+                         argsz);
+}
+
+static uring_fd_t *uring_find(event_ctx_t *ctx, int fd) {
+    for (size_t i = 0; i < sizeof(ctx->uring_fds) / sizeof(ctx->uring_fds[0]); i++) {
+        if (ctx->uring_fds[i].active && ctx->uring_fds[i].fd == fd) {
+            return &ctx->uring_fds[i];
+        }
+    }
+    return NULL;
+}
+
+// Helper: Claim and zero the next SQ slot (NULL if the ring is full).
+// Claims made before the next uring_submit() take consecutive slots:
+// sq_pending counts them so a second claim cannot hand out the slot the
+// first one is still being written into.
+static struct io_uring_sqe *uring_get_sqe(event_ctx_t *ctx) {
+    uint32_t head = atomic_load_explicit(ctx->sq_head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(ctx->sq_tail, memory_order_relaxed);
+    uint32_t slot = tail + ctx->sq_pending;
+    if (slot - head >= ctx->sq_entries) {
+        return NULL;
+    }
+    struct io_uring_sqe *sqe = &ctx->sqes[slot & ctx->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    ctx->sq_array[slot & ctx->sq_mask] = slot & ctx->sq_mask;
+    ctx->sq_pending++;
+    return sqe;
+}
+
+// Helper: Publish every claimed sqe and submit them to the kernel
+static int uring_submit(event_ctx_t *ctx) {
+    uint32_t count = ctx->sq_pending;
+    if (count == 0) {
+        return 0;
+    }
+    uint32_t tail = atomic_load_explicit(ctx->sq_tail, memory_order_relaxed);
+    atomic_store_explicit(ctx->sq_tail, tail + count, memory_order_release);
+    ctx->sq_pending = 0;
+    int ret = sys_io_uring_enter(ctx->ring_fd, count, 0, 0, NULL, 0);
+    return ret < 0 ? -1 : 0;
+}
+
+// Helper: Queue a multishot poll for fd (does not submit)
+static struct io_uring_sqe *uring_queue_poll(event_ctx_t *ctx, int fd, bool want_write) {
+    struct io_uring_sqe *sqe = uring_get_sqe(ctx);
+    if (sqe == NULL) {
+        return NULL;
+    }
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll_events = (unsigned short) (POLLIN | (want_write ? POLLOUT : 0));
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = (uint64_t) fd;
+    return sqe;
+}
+
+// Helper: Queue a cancel for fd's armed poll (does not submit)
+static struct io_uring_sqe *uring_queue_cancel(event_ctx_t *ctx, int fd) {
+    struct io_uring_sqe *sqe = uring_get_sqe(ctx);
+    if (sqe == NULL) {
+        return NULL;
+    }
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->addr = (uint64_t) fd; // user_data of the poll to cancel
+    sqe->user_data = URING_TAG_CTL | (uint64_t) fd;
+    return sqe;
+}
+
+static int uring_backend_init(event_ctx_t *ctx) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ctx->ring_fd = sys_io_uring_setup(URING_ENTRIES, &params);
+    if (ctx->ring_fd < 0) {
+        log_warn("io_uring_setup() failed: %s", strerror(errno));
+        return -1;
+    }
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        log_warn("io_uring lacks IORING_FEAT_SINGLE_MMAP (pre-5.4 kernel)");
+        close(ctx->ring_fd);
+        ctx->ring_fd = -1;
+        return -1;
+    }
+
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ctx->ring_mem_size = sq_size > cq_size ? sq_size : cq_size;
+    ctx->ring_mem = mmap(NULL, ctx->ring_mem_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ctx->ring_fd, IORING_OFF_SQ_RING);
+    ctx->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ctx->sqes = mmap(NULL, ctx->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ctx->ring_fd, IORING_OFF_SQES);
+    if (ctx->ring_mem == MAP_FAILED || ctx->sqes == MAP_FAILED) {
+        log_warn("io_uring ring mmap failed: %s", strerror(errno));
+        if (ctx->ring_mem != MAP_FAILED) {
+            munmap(ctx->ring_mem, ctx->ring_mem_size);
+        }
+        if (ctx->sqes != MAP_FAILED) {
+            munmap(ctx->sqes, ctx->sqes_size);
+        }
+        close(ctx->ring_fd);
+        ctx->ring_fd = -1;
+        return -1;
+    }
+
+    char *ring = ctx->ring_mem;
+    ctx->sq_entries = params.sq_entries;
+    ctx->sq_head = (_Atomic uint32_t *) (void *) (ring + params.sq_off.head);
+    ctx->sq_tail = (_Atomic uint32_t *) (void *) (ring + params.sq_off.tail);
+    ctx->sq_mask = *(uint32_t *) (void *) (ring + params.sq_off.ring_mask);
+    ctx->sq_array = (uint32_t *) (void *) (ring + params.sq_off.array);
+    ctx->sq_pending = 0;
+    ctx->cq_head = (_Atomic uint32_t *) (void *) (ring + params.cq_off.head);
+    ctx->cq_tail = (_Atomic uint32_t *) (void *) (ring + params.cq_off.tail);
+    ctx->cq_mask = *(uint32_t *) (void *) (ring + params.cq_off.ring_mask);
+    ctx->cqes = (struct io_uring_cqe *) (void *) (ring + params.cq_off.cqes);
+
+    memset(ctx->uring_fds, 0, sizeof(ctx->uring_fds));
+    return 0;
+}
+
+static int uring_add_fd(event_ctx_t *ctx, int fd) {
+    uring_fd_t *entry = NULL;
+    for (size_t i = 0; i < sizeof(ctx->uring_fds) / sizeof(ctx->uring_fds[0]); i++) {
+        if (!ctx->uring_fds[i].active) {
+            entry = &ctx->uring_fds[i];
+            break;
+        }
+    }
+    if (entry == NULL || uring_queue_poll(ctx, fd, false) == NULL) {
+        return -1;
+    }
+    if (uring_submit(ctx) < 0) {
+        log_error("io_uring poll submit (fd=%d) failed: %s", fd, strerror(errno));
+        return -1;
+    }
+    entry->fd = fd;
+    entry->want_write = false;
+    entry->active = true;
+    return 0;
+}
+
+static int uring_del_fd(event_ctx_t *ctx, int fd) {
+    uring_fd_t *entry = uring_find(ctx, fd);
+    if (entry == NULL) {
+        return -1;
+    }
+    entry->active = false;
+    if (uring_queue_cancel(ctx, fd) == NULL || uring_submit(ctx) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// Interest change is cancel-plus-rearm: both submitted in one enter, so
+// readiness cannot be lost in between
+static int uring_mod_fd(event_ctx_t *ctx, int fd, bool want_write) {
+    uring_fd_t *entry = uring_find(ctx, fd);
+    if (entry == NULL) {
+        return -1;
+    }
+    if (entry->want_write == want_write) {
+        return 0;
+    }
+    entry->want_write = want_write;
+    if (uring_queue_cancel(ctx, fd) == NULL || uring_queue_poll(ctx, fd, want_write) == NULL) {
+        ctx->sq_pending = 0; // Drop any half-built pair; nothing was published
+        return -1;
+    }
+    return uring_submit(ctx);
+}
+
+static int uring_wait_ready(event_ctx_t *ctx, int timeout_ms, event_ready_t *ready,
+                            int max_ready) {
+    // Only pay the syscall when no completions are already queued
+    uint32_t head = atomic_load_explicit(ctx->cq_head, memory_order_relaxed);
+    if (head == atomic_load_explicit(ctx->cq_tail, memory_order_acquire)) {
+        if (timeout_ms == 0) {
+            return 0;
+        }
+        int ret;
+        if (timeout_ms < 0) {
+            ret = sys_io_uring_enter(ctx->ring_fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        } else {
+            struct {
+                int64_t tv_sec;
+                long long tv_nsec;
+            } ts = {timeout_ms / 1000, (long long) (timeout_ms % 1000) * 1000000LL};
+            struct io_uring_getevents_arg arg = {.ts = (uint64_t) (uintptr_t) &ts};
+            ret = sys_io_uring_enter(ctx->ring_fd, 0, 1,
+                                     IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg,
+                                     sizeof(arg));
+        }
+        if (ret < 0) {
+            if (errno == ETIME) {
+                return 0;
+            }
+            return -1; // EINTR and real errors surface like epoll_wait
+        }
+    }
+
+    int count = 0;
+    uint32_t tail = atomic_load_explicit(ctx->cq_tail, memory_order_acquire);
+    while (head != tail && count < max_ready) {
+        const struct io_uring_cqe *cqe = &ctx->cqes[head & ctx->cq_mask];
+        head++;
+        if ((cqe->user_data & URING_TAG_CTL) != 0 || cqe->res < 0) {
+            continue; // Cancel acks and cancelled polls
+        }
+        int fd = (int) cqe->user_data;
+        uint32_t mask = (uint32_t) cqe->res;
+        ready[count++] = (event_ready_t) {
+            .fd = fd,
+            .readable = (mask & (POLLIN | POLLERR | POLLHUP)) != 0,
+            .writable = (mask & POLLOUT) != 0,
+        };
+        if (!(cqe->flags & IORING_CQE_F_MORE)) {
+            // The kernel retired this multishot poll; re-arm it
+            const uring_fd_t *entry = uring_find(ctx, fd);
+            if (entry != NULL && uring_queue_poll(ctx, fd, entry->want_write) != NULL) {
+                uring_submit(ctx);
+            }
+        }
+    }
+    atomic_store_explicit(ctx->cq_head, head, memory_order_release);
+    return count;
+}
+
+static void uring_cleanup(event_ctx_t *ctx) {
+    if (ctx->ring_fd < 0) {
+        return;
+    }
+    munmap(ctx->sqes, ctx->sqes_size);
+    munmap(ctx->ring_mem, ctx->ring_mem_size);
+    close(ctx->ring_fd);
+    ctx->ring_fd = -1;
+}
+#endif // BEAMLINE_HAVE_IO_URING
+
+int event_init(void) {
+    const char *requested = getenv("BEAMLINE_EVENT_BACKEND");
+    bool want_uring = (requested != NULL && strcmp(requested, "io_uring") == 0);
+
+#ifdef BEAMLINE_HAVE_IO_URING
+    // Opt-in: syscall-count wins matter most on mitigated hosts, but
+    // epoll remains the battle-tested default. Probe with a throwaway
+    // ring so every later context open is expected to succeed.
+    if (want_uring) {
+        event_ctx_t probe = {.ring_fd = -1};
+        if (uring_backend_init(&probe) == 0) {
+            uring_cleanup(&probe);
+            g_backend = EVENT_BACKEND_IO_URING;
+        } else {
+            log_warn("Falling back to epoll backend");
+        }
+    }
+#else
+    if (want_uring) {
+        log_warn("io_uring backend not available on this platform");
+    }
+#endif
+
+#ifdef BEAMLINE_HAVE_EPOLL
+    bool want_epoll = (requested == NULL || strcmp(requested, "epoll") == 0 || want_uring);
+    if (want_epoll && g_backend != EVENT_BACKEND_IO_URING) {
+        g_backend = EVENT_BACKEND_EPOLL;
+    }
+#else
+    bool want_epoll = false;
+    if (requested != NULL && strcmp(requested, "epoll") == 0) {
+        log_warn("epoll backend not available on this platform, using select");
+    }
+#endif
+
+    if (g_backend == EVENT_BACKEND_SELECT && requested != NULL &&
+        strcmp(requested, "select") != 0 && !want_epoll) {
+        log_warn("Unknown event backend '%s', using select", requested);
+    }
+
+    memset(g_ctx_pool, 0, sizeof(g_ctx_pool));
+    log_info("Event backend: %s", g_backend == EVENT_BACKEND_IO_URING ? "io_uring"
+                                  : g_backend == EVENT_BACKEND_EPOLL  ? "epoll"
+                                                                      : "select");
+    return 0;
+}
+
+event_backend_t event_backend(void) {
+    return g_backend;
+}
+
+event_ctx_t *event_ctx_open(void) {
+    event_ctx_t *ctx = NULL;
+    for (size_t i = 0; i < sizeof(g_ctx_pool) / sizeof(g_ctx_pool[0]); i++) {
+        if (!g_ctx_pool[i].in_use) {
+            ctx = &g_ctx_pool[i];
+            break;
+        }
+    }
+    if (ctx == NULL) {
+        log_error("Event context pool exhausted (max %d)", BEAMLINE_MAX_WORKERS);
+        return NULL;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->epoll_fd = -1;
+#ifdef BEAMLINE_HAVE_IO_URING
+    ctx->ring_fd = -1;
+    if (g_backend == EVENT_BACKEND_IO_URING && uring_backend_init(ctx) < 0) {
+        return NULL;
+    }
+#endif
+#ifdef BEAMLINE_HAVE_EPOLL
+    if (g_backend == EVENT_BACKEND_EPOLL && epoll_backend_init(ctx) < 0) {
+        return NULL;
+    }
+#endif
+    ctx->in_use = true;
+    return ctx;
+}
+
+void event_ctx_close(event_ctx_t *ctx) {
+    if (ctx == NULL || !ctx->in_use) {
+        return;
+    }
+#ifdef BEAMLINE_HAVE_IO_URING
+    uring_cleanup(ctx);
+#endif
+#ifdef BEAMLINE_HAVE_EPOLL
+    if (ctx->epoll_fd >= 0) {
+        close(ctx->epoll_fd);
+        ctx->epoll_fd = -1;
+    }
+#endif
+    ctx->select_count = 0;
+    ctx->in_use = false;
+}
+
+int event_add_fd(event_ctx_t *ctx, int fd) {
+#ifdef BEAMLINE_HAVE_IO_URING
+    if (g_backend == EVENT_BACKEND_IO_URING) {
+        return uring_add_fd(ctx, fd);
+    }
+#endif
+#ifdef BEAMLINE_HAVE_EPOLL
+    if (g_backend == EVENT_BACKEND_EPOLL) {
+        return epoll_add_fd(ctx, fd);
+    }
+#endif
+    return select_add_fd(ctx, fd);
+}
+
+int event_del_fd(event_ctx_t *ctx, int fd) {
+#ifdef BEAMLINE_HAVE_IO_URING
+    if (g_backend == EVENT_BACKEND_IO_URING) {
+        return uring_del_fd(ctx, fd);
+    }
+#endif
+#ifdef BEAMLINE_HAVE_EPOLL
+    if (g_backend == EVENT_BACKEND_EPOLL) {
+        return epoll_del_fd(ctx, fd);
+    }
+#endif
+    return select_del_fd(ctx, fd);
+}
+
+int event_mod_fd(event_ctx_t *ctx, int fd, bool want_write) {
+#ifdef BEAMLINE_HAVE_IO_URING
+    if (g_backend == EVENT_BACKEND_IO_URING) {
+        return uring_mod_fd(ctx, fd, want_write);
+    }
+#endif
+#ifdef BEAMLINE_HAVE_EPOLL
+    if (g_backend == EVENT_BACKEND_EPOLL) {
+        return epoll_mod_fd(ctx, fd, want_write);
+    }
+#endif
+    return select_mod_fd(ctx, fd, want_write);
+}
+
+int event_wait(event_ctx_t *ctx, int timeout_ms, event_ready_t *ready, int max_ready) {
+#ifdef BEAMLINE_HAVE_IO_URING
+    if (g_backend == EVENT_BACKEND_IO_URING) {
+        return uring_wait_ready(ctx, timeout_ms, ready, max_ready);
+    }
+#endif
+#ifdef BEAMLINE_HAVE_EPOLL
+    if (g_backend == EVENT_BACKEND_EPOLL) {
+        return epoll_wait_ready(ctx, timeout_ms, ready, max_ready);
+    }
+#endif
+    return select_wait(ctx, timeout_ms, ready, max_ready);
+}
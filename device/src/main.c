@@ -2,6 +2,7 @@
 #define _POSIX_C_SOURCE 200809L
 #endif
 
+#include <pthread.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <time.h>
@@ -9,7 +10,10 @@
 
 #include "config.h"
 #include "devices.h"
+#include "persist.h"
 #include "server.h"
+#include "shm.h"
+#include "stats.h"
 #include "utils.h"
 
 static volatile sig_atomic_t g_running = 1;
@@ -23,12 +27,44 @@ static void signal_handler(int sig) {
     // Logging will be done in main loop
 }
 
+// Simulation thread: runs devices_update() on a steady absolute-deadline
+// clock so kinematic fidelity is decoupled from network activity. Values
+// are published to the network thread through the seqlock snapshot in
+// devices.c; writes arrive through the request mailbox.
+static void *simulation_thread(void *arg) {
+    (void) arg;
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    struct timespec last = next;
+
+    while (g_running) {
+        next.tv_nsec += (long) BEAMLINE_MOTOR_UPDATE_INTERVAL_MS * 1000000L;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_sec += next.tv_nsec / 1000000000L;
+            next.tv_nsec %= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double dt = ((double) (now.tv_sec - last.tv_sec)) +
+                    ((double) (now.tv_nsec - last.tv_nsec) / 1e9);
+        devices_update(dt);
+        last = now;
+    }
+
+    return NULL;
+}
+
 int main(void) {
     log_init();
+    stats_init();
     devices_init();
+    devices_shm_export(); // Non-fatal: local clients just fall back to sockets
+    devices_state_attach(); // Non-fatal: no BEAMLINE_STATE_FILE means cold start
 
-    int listen_fd = server_init();
-    if (listen_fd < 0) {
+    if (server_init() < 0) {
         log_error("Failed to initialize server");
         return EXIT_FAILURE;
     }
@@ -36,35 +72,30 @@ int main(void) {
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
 
-    log_info("Beamline simulator listening on port %d", BEAMLINE_PORT);
+    pthread_t sim_thread;
+    if (pthread_create(&sim_thread, NULL, simulation_thread, NULL) != 0) {
+        log_error("Failed to start simulation thread");
+        server_cleanup();
+        return EXIT_FAILURE;
+    }
 
-    struct timespec last_update = {0};
-    clock_gettime(CLOCK_MONOTONIC, &last_update);
+    log_info("Beamline simulator listening on port %d", BEAMLINE_PORT);
 
     while (g_running) {
-        server_run_once(listen_fd);
+        server_run_once();
 
         // Check if signal was received (async-signal-safe check)
         if (g_signal_received) {
             log_info("Received signal, shutting down...");
             g_signal_received = 0; // Reset flag
         }
-
-        // Update devices every 10ms
-        struct timespec now;
-        clock_gettime(CLOCK_MONOTONIC, &now);
-        double dt = ((double) (now.tv_sec - last_update.tv_sec)) +
-                    ((double) (now.tv_nsec - last_update.tv_nsec) / 1e9);
-        if (dt >= 0.01) {
-            devices_update(dt);
-            last_update = now;
-        }
-
-        // Small sleep to prevent 100% CPU
-        nanosleep(&(struct timespec) {.tv_sec = 0, .tv_nsec = 1000000}, NULL); // 1ms
     }
 
-    server_cleanup(listen_fd);
+    pthread_join(sim_thread, NULL);
+    server_cleanup();
+    shm_export_close();
+    persist_close();
     log_info("Server shutdown complete");
+    log_shutdown();
     return EXIT_SUCCESS;
 }
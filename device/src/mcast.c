@@ -0,0 +1,142 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "mcast.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include "config.h"
+#include "devices.h"
+#include "utils.h"
+
+static int g_mcast_fd = -1;
+static struct sockaddr_in g_mcast_addr;
+static pv_handle_t g_mcast_pvs[BEAMLINE_MCAST_MAX_PVS];
+static int g_mcast_pv_count = 0;
+static int64_t g_last_publish_ms = 0;
+
+// Helper: Resolve one group token (PV name or glob pattern) into handles
+static void resolve_token(const char *token) {
+    if (strchr(token, '*') == NULL && strchr(token, '?') == NULL) {
+        pv_handle_t handle = pv_handle(token);
+        if (handle == PV_HANDLE_INVALID) {
+            log_warn("Multicast group PV not found: %s", token);
+        } else if (g_mcast_pv_count < BEAMLINE_MCAST_MAX_PVS) {
+            g_mcast_pvs[g_mcast_pv_count++] = handle;
+        }
+        return;
+    }
+
+    // Glob: expand through pv_list and recurse on the plain names
+    char expanded[BEAMLINE_RESPONSE_BUFFER_SIZE];
+    if (pv_list(token, expanded, sizeof(expanded)) <= 0) {
+        log_warn("Multicast group pattern matched nothing: %s", token);
+        return;
+    }
+    char *save = NULL;
+    for (char *name = strtok_r(expanded, ",", &save); name != NULL;
+         name = strtok_r(NULL, ",", &save)) {
+        resolve_token(name);
+    }
+}
+
+bool mcast_init(void) {
+    const char *addr_str = getenv("BEAMLINE_MCAST_ADDR");
+    const char *pvs_str = getenv("BEAMLINE_MCAST_PVS");
+    if (addr_str == NULL || pvs_str == NULL) {
+        return false; // Publisher disabled
+    }
+
+    memset(&g_mcast_addr, 0, sizeof(g_mcast_addr));
+    g_mcast_addr.sin_family = AF_INET;
+    g_mcast_addr.sin_port = htons(BEAMLINE_MCAST_PORT);
+    if (inet_pton(AF_INET, addr_str, &g_mcast_addr.sin_addr) != 1) {
+        log_warn("Invalid BEAMLINE_MCAST_ADDR: %s", addr_str);
+        return false;
+    }
+
+    g_mcast_pv_count = 0;
+    char pvs_copy[BEAMLINE_RESPONSE_BUFFER_SIZE];
+    strncpy(pvs_copy, pvs_str, sizeof(pvs_copy) - 1);
+    pvs_copy[sizeof(pvs_copy) - 1] = '\0';
+    char *save = NULL;
+    for (char *token = strtok_r(pvs_copy, ",", &save); token != NULL;
+         token = strtok_r(NULL, ",", &save)) {
+        resolve_token(token);
+    }
+    if (g_mcast_pv_count == 0) {
+        log_warn("BEAMLINE_MCAST_PVS resolved to no PVs, multicast disabled");
+        return false;
+    }
+
+    g_mcast_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (g_mcast_fd < 0) {
+        log_warn("Multicast socket failed: %s", strerror(errno));
+        return false;
+    }
+    // Stay on the local segment; control-room receivers share it
+    unsigned char ttl = 1;
+    setsockopt(g_mcast_fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+
+    g_last_publish_ms = 0;
+    log_info("Multicast publisher active: %d PVs -> %s:%d every %d ms", g_mcast_pv_count,
+             addr_str, BEAMLINE_MCAST_PORT, BEAMLINE_MCAST_INTERVAL_MS);
+    return true;
+}
+
+bool mcast_active(void) {
+    return g_mcast_fd >= 0;
+}
+
+int64_t mcast_deadline_ms(void) {
+    return g_last_publish_ms + BEAMLINE_MCAST_INTERVAL_MS;
+}
+
+void mcast_service(int64_t now_ms) {
+    if (g_mcast_fd < 0 || now_ms < mcast_deadline_ms()) {
+        return;
+    }
+
+    // One coalesced datagram for the whole group, regardless of how many
+    // receivers joined
+    char frame[BEAMLINE_RESPONSE_BUFFER_SIZE];
+    memcpy(frame, "DATA:", 5);
+    size_t pos = 5;
+    for (int i = 0; i < g_mcast_pv_count; i++) {
+        const pv_t *pv = pv_from_handle(g_mcast_pvs[i]);
+        size_t name_len = strlen(pv->name);
+        if (pos + name_len + FMT_DOUBLE_MAX + 3 > sizeof(frame)) {
+            break;
+        }
+        if (i > 0) {
+            frame[pos++] = ',';
+        }
+        memcpy(frame + pos, pv->name, name_len);
+        pos += name_len;
+        frame[pos++] = '=';
+        pos += fmt_double(frame + pos, sizeof(frame) - pos, pv_read(pv));
+    }
+    frame[pos++] = '\n';
+
+    if (sendto(g_mcast_fd, frame, pos, 0, (const struct sockaddr *) &g_mcast_addr,
+               sizeof(g_mcast_addr)) < 0) {
+        log_warn("Multicast sendto failed: %s", strerror(errno));
+    }
+    g_last_publish_ms = now_ms;
+}
+
+void mcast_close(void) {
+    if (g_mcast_fd >= 0) {
+        close(g_mcast_fd);
+        g_mcast_fd = -1;
+    }
+    g_mcast_pv_count = 0;
+}
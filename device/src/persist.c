@@ -0,0 +1,235 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "persist.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "utils.h"
+
+static void *g_map = NULL;
+static size_t g_map_size = 0;
+static persist_header_t *g_hdr = NULL;
+static persist_pv_rec_t *g_pv_recs = NULL;
+static persist_motor_rec_t *g_motor_recs = NULL;
+static int64_t g_last_sync_ms = 0;
+
+// Prior state read from the file before it is reinitialized; lookups
+// scan these so restore works even if the registry was resized
+static persist_pv_rec_t *g_prior_pvs = NULL;
+static persist_motor_rec_t *g_prior_motors = NULL;
+static int g_prior_pv_count = 0;
+static int g_prior_motor_count = 0;
+
+static int64_t get_time_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t) ts.tv_sec * 1000) + ((int64_t) ts.tv_nsec / 1000000);
+}
+
+static void prior_free(void) {
+    free(g_prior_pvs);
+    free(g_prior_motors);
+    g_prior_pvs = NULL;
+    g_prior_motors = NULL;
+    g_prior_pv_count = 0;
+    g_prior_motor_count = 0;
+}
+
+// Helper: Read any valid prior state into heap buffers before the file
+// is truncated and rewritten. An odd seq means the previous writer died
+// mid-publish, so the image may be torn and is discarded.
+static void prior_read(int fd) {
+    persist_header_t hdr;
+    if (pread(fd, &hdr, sizeof(hdr), 0) != (ssize_t) sizeof(hdr)) {
+        return;
+    }
+    if (hdr.magic != BEAMLINE_STATE_MAGIC || hdr.version != BEAMLINE_STATE_VERSION) {
+        return;
+    }
+    uint64_t seq = atomic_load_explicit(&hdr.seq, memory_order_relaxed);
+    if (seq % 2 != 0) {
+        log_warn("State file torn by a mid-publish crash, cold-starting");
+        return;
+    }
+    if (hdr.pv_count > 1000000 || hdr.motor_count > 1000000) {
+        return; // Corrupt counts
+    }
+
+    size_t pv_bytes = (size_t) hdr.pv_count * sizeof(persist_pv_rec_t);
+    size_t motor_bytes = (size_t) hdr.motor_count * sizeof(persist_motor_rec_t);
+    persist_pv_rec_t *pvs = malloc(pv_bytes > 0 ? pv_bytes : 1);
+    persist_motor_rec_t *motors = malloc(motor_bytes > 0 ? motor_bytes : 1);
+    if (pvs == NULL || motors == NULL) {
+        free(pvs);
+        free(motors);
+        return;
+    }
+    if (pread(fd, pvs, pv_bytes, (off_t) sizeof(hdr)) != (ssize_t) pv_bytes ||
+        pread(fd, motors, motor_bytes, (off_t) (sizeof(hdr) + pv_bytes)) !=
+            (ssize_t) motor_bytes) {
+        free(pvs);
+        free(motors);
+        return;
+    }
+
+    g_prior_pvs = pvs;
+    g_prior_motors = motors;
+    g_prior_pv_count = (int) hdr.pv_count;
+    g_prior_motor_count = (int) hdr.motor_count;
+}
+
+bool persist_open(const char *path, int pv_count, int motor_count) {
+    persist_close(); // Re-open replaces any previous mapping
+    prior_free();
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        log_warn("open(%s) failed: %s", path, strerror(errno));
+        return false;
+    }
+    prior_read(fd);
+
+    size_t size = sizeof(persist_header_t) +
+                  (size_t) pv_count * sizeof(persist_pv_rec_t) +
+                  (size_t) motor_count * sizeof(persist_motor_rec_t);
+    if (ftruncate(fd, (off_t) size) < 0) {
+        log_warn("ftruncate(%s) failed: %s", path, strerror(errno));
+        close(fd);
+        prior_free();
+        return false;
+    }
+
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        log_warn("mmap(%s) failed: %s", path, strerror(errno));
+        prior_free();
+        return false;
+    }
+
+    g_map = map;
+    g_map_size = size;
+    g_hdr = map;
+    g_pv_recs = (persist_pv_rec_t *) ((char *) map + sizeof(persist_header_t));
+    g_motor_recs = (persist_motor_rec_t *) (g_pv_recs + pv_count);
+    g_last_sync_ms = get_time_ms();
+
+    memset(map, 0, size);
+    g_hdr->version = BEAMLINE_STATE_VERSION;
+    g_hdr->pv_count = (uint32_t) pv_count;
+    g_hdr->motor_count = (uint32_t) motor_count;
+    atomic_store_explicit(&g_hdr->seq, 0, memory_order_relaxed);
+    // Magic last: a crash before this point leaves an invalid file
+    atomic_thread_fence(memory_order_release);
+    g_hdr->magic = BEAMLINE_STATE_MAGIC;
+    return true;
+}
+
+bool persist_loaded(void) {
+    return g_prior_pvs != NULL;
+}
+
+bool persist_lookup_pv(uint64_t hash, double *value) {
+    for (int i = 0; i < g_prior_pv_count; i++) {
+        if (g_prior_pvs[i].hash == hash) {
+            *value = g_prior_pvs[i].value;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool persist_lookup_motor(uint64_t hash, double *target, bool *moving) {
+    for (int i = 0; i < g_prior_motor_count; i++) {
+        if (g_prior_motors[i].hash == hash) {
+            *target = g_prior_motors[i].target;
+            *moving = g_prior_motors[i].moving != 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+void persist_set_pv_hash(int idx, uint64_t hash) {
+    if (g_hdr == NULL || idx < 0 || (uint32_t) idx >= g_hdr->pv_count) {
+        return;
+    }
+    g_pv_recs[idx].hash = hash;
+}
+
+void persist_set_motor_hash(int idx, uint64_t hash) {
+    if (g_hdr == NULL || idx < 0 || (uint32_t) idx >= g_hdr->motor_count) {
+        return;
+    }
+    g_motor_recs[idx].hash = hash;
+}
+
+void persist_begin(void) {
+    if (g_hdr == NULL) {
+        return;
+    }
+    uint64_t seq = atomic_load_explicit(&g_hdr->seq, memory_order_relaxed);
+    atomic_store_explicit(&g_hdr->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+void persist_store_values(const double *values, int count) {
+    if (g_hdr == NULL) {
+        return;
+    }
+    if ((uint32_t) count > g_hdr->pv_count) {
+        count = (int) g_hdr->pv_count;
+    }
+    for (int i = 0; i < count; i++) {
+        g_pv_recs[i].value = values[i];
+    }
+}
+
+void persist_store_motor(int idx, double target, bool moving) {
+    if (g_hdr == NULL || idx < 0 || (uint32_t) idx >= g_hdr->motor_count) {
+        return;
+    }
+    g_motor_recs[idx].target = target;
+    g_motor_recs[idx].moving = moving ? 1 : 0;
+}
+
+void persist_end(void) {
+    if (g_hdr == NULL) {
+        return;
+    }
+    uint64_t seq = atomic_load_explicit(&g_hdr->seq, memory_order_relaxed);
+    atomic_store_explicit(&g_hdr->seq, seq + 1, memory_order_release);
+
+    // Throttled flush: writeback is asynchronous, so a tick publishes in
+    // nanoseconds and a crash loses at most one sync interval
+    int64_t now = get_time_ms();
+    if (now - g_last_sync_ms >= BEAMLINE_STATE_SYNC_INTERVAL_MS) {
+        msync(g_map, g_map_size, MS_ASYNC);
+        g_last_sync_ms = now;
+    }
+}
+
+void persist_close(void) {
+    if (g_map == NULL) {
+        prior_free();
+        return;
+    }
+    msync(g_map, g_map_size, MS_SYNC);
+    munmap(g_map, g_map_size);
+    g_map = NULL;
+    g_map_size = 0;
+    g_hdr = NULL;
+    g_pv_recs = NULL;
+    g_motor_recs = NULL;
+    prior_free();
+}
@@ -1,5 +1,6 @@
 #include "protocol.h"
 
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -22,30 +23,88 @@ const char *error_code_string(error_code_t code) {
     }
 }
 
-// Helper: Parse simple commands without colon (PING, QUIT, STOP, LIST)
-static bool parse_simple_command(const char *cmd_str, cmd_t *cmd) {
-    if (strcmp(cmd_str, "PING") == 0) {
-        cmd->type = CMD_PING;
-        return true;
-    }
-    if (strcmp(cmd_str, "QUIT") == 0) {
-        cmd->type = CMD_QUIT;
-        return true;
+// Helper: Split a comma-separated PV list into cmd->targets, in place:
+// commas become NULs and targets point into the buffer. Returns false if
+// the list is empty, has an empty element, or overflows.
+static bool split_target_list(char *list_str, cmd_t *cmd) {
+    cmd->target_count = 0;
+
+    char *start = list_str;
+    while (true) {
+        char *comma = strchr(start, ',');
+        if (comma != NULL) {
+            *comma = '\0';
+        }
+
+        if (*start == '\0') {
+            return false;
+        }
+        if (cmd->target_count >= BEAMLINE_MAX_CMD_TARGETS) {
+            return false;
+        }
+        cmd->targets[cmd->target_count++] = start;
+
+        if (comma == NULL) {
+            break;
+        }
+        start = comma + 1;
     }
-    if (strcmp(cmd_str, "STOP") == 0) {
-        cmd->type = CMD_STOP;
-        return true;
+
+    // Keep the first target in cmd->target for single-PV consumers
+    cmd->target = cmd->targets[0];
+    return true;
+}
+
+// Helper: Parse the multi-assignment PUT form (PUT:PV1=V1,PV2=V2,...)
+static bool parse_put_assignments(char *target_str, cmd_t *cmd) {
+    cmd->target_count = 0;
+
+    char *start = target_str;
+    while (start != NULL && *start != '\0') {
+        char *comma = strchr(start, ',');
+        if (comma != NULL) {
+            *comma = '\0';
+        }
+
+        char *equals = strchr(start, '=');
+        if (equals == NULL) {
+            return false;
+        }
+        *equals = '\0';
+
+        if (*start == '\0') {
+            return false;
+        }
+        if (cmd->target_count >= BEAMLINE_MAX_CMD_TARGETS) {
+            return false;
+        }
+        if (!str_to_double(equals + 1, &cmd->values[cmd->target_count])) {
+            return false;
+        }
+
+        cmd->targets[cmd->target_count++] = start;
+
+        start = (comma != NULL) ? comma + 1 : NULL;
     }
-    if (strcmp(cmd_str, "LIST") == 0) {
-        cmd->type = CMD_LIST;
-        return true;
+
+    if (cmd->target_count == 0) {
+        return false;
     }
-    return false;
+
+    cmd->type = CMD_PUT;
+    cmd->target = cmd->targets[0];
+    cmd->value = cmd->values[0];
+    cmd->has_value = true;
+    return true;
 }
 
-// Helper: Parse PUT command (PUT:PV:VALUE)
-static bool parse_put_command(const char *target_str, cmd_t *cmd) {
-    char *value_colon = strrchr((char *) target_str, ':');
+// Helper: Parse PUT command (PUT:PV:VALUE or PUT:PV1=V1,PV2=V2,...)
+static bool parse_put_command(char *target_str, cmd_t *cmd) {
+    if (strchr(target_str, '=') != NULL) {
+        return parse_put_assignments(target_str, cmd);
+    }
+
+    char *value_colon = strrchr(target_str, ':');
     if (value_colon == NULL) {
         return false;
     }
@@ -58,20 +117,22 @@ static bool parse_put_command(const char *target_str, cmd_t *cmd) {
     }
 
     cmd->type = CMD_PUT;
-    strncpy(cmd->target, pv_name, BEAMLINE_PV_NAME_MAX - 1);
-    cmd->target[BEAMLINE_PV_NAME_MAX - 1] = '\0';
+    cmd->target = pv_name;
     cmd->has_value = true;
+
+    cmd->targets[0] = pv_name;
+    cmd->values[0] = cmd->value;
+    cmd->target_count = 1;
     return true;
 }
 
 // Helper: Parse MOVE command (MOVE:MOTOR:POSITION)
-static bool parse_move_command(const char *target_str, cmd_t *cmd) {
-    char *value_colon = strrchr((char *) target_str, ':');
+static bool parse_move_command(char *target_str, cmd_t *cmd) {
+    char *value_colon = strrchr(target_str, ':');
     if (value_colon == NULL) {
         return false;
     }
     *value_colon = '\0';
-    const char *motor_name = target_str;
     const char *pos_str = value_colon + 1;
 
     if (!str_to_double(pos_str, &cmd->value)) {
@@ -79,112 +140,227 @@ static bool parse_move_command(const char *target_str, cmd_t *cmd) {
     }
 
     cmd->type = CMD_MOVE;
-    strncpy(cmd->target, motor_name, BEAMLINE_PV_NAME_MAX - 1);
-    cmd->target[BEAMLINE_PV_NAME_MAX - 1] = '\0';
+    cmd->target = target_str;
     cmd->has_value = true;
     return true;
 }
 
-// Helper: Parse MONITOR command (MONITOR:PV:INTERVAL_MS)
-static bool parse_monitor_command(const char *target_str, cmd_t *cmd) {
-    char *interval_colon = strrchr((char *) target_str, ':');
-    if (interval_colon == NULL) {
+// Helper: Parse MONITOR command (MONITOR:PV1[,PV2,...]:INTERVAL_MS[:DEADBAND])
+static bool parse_monitor_command(char *target_str, cmd_t *cmd) {
+    char *last_colon = strrchr(target_str, ':');
+    if (last_colon == NULL) {
         return false;
     }
-    *interval_colon = '\0';
-    const char *pv_name = target_str;
-    const char *interval_str = interval_colon + 1;
+    *last_colon = '\0';
+    const char *last_field = last_colon + 1;
 
     double interval_d;
-    if (!str_to_double(interval_str, &interval_d)) {
+    double deadband = 0.0;
+
+    // If the field before the last one is also numeric, the last field is
+    // the deadband and the one before it the interval
+    char *prev_colon = strrchr(target_str, ':');
+    double prev_d;
+    if (prev_colon != NULL && str_to_double(prev_colon + 1, &prev_d)) {
+        if (!str_to_double(last_field, &deadband)) {
+            return false;
+        }
+        *prev_colon = '\0';
+        interval_d = prev_d;
+    } else if (!str_to_double(last_field, &interval_d)) {
+        return false;
+    }
+
+    if (!split_target_list(target_str, cmd)) {
         return false;
     }
 
     cmd->type = CMD_MONITOR;
-    strncpy(cmd->target, pv_name, BEAMLINE_PV_NAME_MAX - 1);
-    cmd->target[BEAMLINE_PV_NAME_MAX - 1] = '\0';
     cmd->monitor_interval_ms = (int) interval_d;
+    cmd->monitor_deadband = deadband;
     return true;
 }
 
-bool protocol_parse(const char *input, cmd_t *cmd) {
-    if (input == NULL || cmd == NULL) {
+// Helper: Parse SCAN command (SCAN:MOTOR,DET1[,DET2,...]:START:STOP:STEP).
+// The three numeric trajectory fields are peeled off the right so PV names
+// may contain colons, as elsewhere in the protocol.
+static bool parse_scan_command(char *target_str, cmd_t *cmd) {
+    double fields[3]; // step, stop, start (right to left)
+
+    for (int i = 0; i < 3; i++) {
+        char *colon = strrchr(target_str, ':');
+        if (colon == NULL) {
+            return false;
+        }
+        *colon = '\0';
+        if (!str_to_double(colon + 1, &fields[i])) {
+            return false;
+        }
+    }
+
+    if (!split_target_list(target_str, cmd)) {
         return false;
     }
+    if (cmd->target_count < 2) {
+        return false; // Need a motor plus at least one detector
+    }
 
-    // Initialize cmd
-    cmd->type = CMD_INVALID;
-    cmd->target[0] = '\0';
-    cmd->value = 0.0;
-    cmd->has_value = false;
-    cmd->monitor_interval_ms = 0;
+    cmd->type = CMD_SCAN;
+    cmd->scan_start = fields[2];
+    cmd->scan_stop = fields[1];
+    cmd->scan_step = fields[0];
+    return true;
+}
 
-    // Copy input to work buffer and trim
-    char work[BEAMLINE_CMD_BUFFER_SIZE];
-    strncpy(work, input, sizeof(work) - 1);
-    work[sizeof(work) - 1] = '\0';
-    trim(work);
+// Helper: Parse GET command (GET:PV or batched GET:PV1,PV2,...)
+static bool parse_get_command(char *target_str, cmd_t *cmd) {
+    if (!split_target_list(target_str, cmd)) {
+        return false;
+    }
+    cmd->type = CMD_GET;
+    return true;
+}
 
-    // Remove trailing newline if present
-    size_t len = strlen(work);
-    if (len > 0 && work[len - 1] == '\n') {
-        work[len - 1] = '\0';
-        len--;
+// Helper: Parse GETW command (GETW:PV) — waveform PVs only; the reply is
+// binary, not line-oriented
+static bool parse_getw_command(char *target_str, cmd_t *cmd) {
+    if (target_str[0] == '\0') {
+        return false;
     }
+    cmd->type = CMD_GETW;
+    cmd->target = target_str;
+    return true;
+}
 
-    if (len == 0) {
+// Helper: Parse GETHIST command (GETHIST:PV:N) — last N archived
+// samples; the reply is binary
+static bool parse_gethist_command(char *target_str, cmd_t *cmd) {
+    char *count_colon = strrchr(target_str, ':');
+    if (count_colon == NULL) {
         return false;
     }
+    *count_colon = '\0';
+    if (!str_to_double(count_colon + 1, &cmd->value) || cmd->value < 1) {
+        return false;
+    }
+    cmd->type = CMD_GETHIST;
+    cmd->target = target_str;
+    cmd->has_value = true;
+    return true;
+}
 
-    // Find first colon
-    char *colon = strchr(work, ':');
-    if (colon == NULL) {
-        // Commands without colon: PING, QUIT, STOP, LIST
-        return parse_simple_command(work, cmd);
+// Helper: Parse STATUS command (STATUS:MOTOR)
+static bool parse_status_command(char *target_str, cmd_t *cmd) {
+    cmd->type = CMD_STATUS;
+    cmd->target = target_str;
+    return true;
+}
+
+// Helper: Parse the LIST pattern form (LIST:GLOB)
+static bool parse_list_command(char *target_str, cmd_t *cmd) {
+    cmd->type = CMD_LIST;
+    cmd->target = target_str;
+    return true;
+}
+
+// Verb dispatch: a compile-time perfect hash over (first char, last
+// char, length) maps each verb to one slot of a flat table, so dispatch
+// is one hash plus one memcmp instead of a strcmp chain that grows with
+// every new command. VERB_SLOT is a constant expression, so a new verb
+// that collides fails the build with a duplicate-initializer error —
+// re-pick the multiplier then (found by exhaustive search).
+typedef struct {
+    const char *verb;
+    uint8_t len;
+    cmd_type_t bare_type; // Colon-less form, or CMD_INVALID if none
+    bool (*parse)(char *target_str, cmd_t *cmd); // Colon form, or NULL
+} verb_entry_t;
+
+#define VERB_TABLE_SIZE 32
+#define VERB_SLOT(first, last, n) ((5 * (first) + 22 * (last) + (n)) & (VERB_TABLE_SIZE - 1))
+
+static const verb_entry_t g_verb_table[VERB_TABLE_SIZE] = {
+    [VERB_SLOT('G', 'T', 3)] = {"GET", 3, CMD_INVALID, parse_get_command},
+    [VERB_SLOT('G', 'W', 4)] = {"GETW", 4, CMD_INVALID, parse_getw_command},
+    [VERB_SLOT('G', 'T', 7)] = {"GETHIST", 7, CMD_INVALID, parse_gethist_command},
+    [VERB_SLOT('P', 'T', 3)] = {"PUT", 3, CMD_INVALID, parse_put_command},
+    [VERB_SLOT('M', 'E', 4)] = {"MOVE", 4, CMD_INVALID, parse_move_command},
+    [VERB_SLOT('S', 'S', 6)] = {"STATUS", 6, CMD_INVALID, parse_status_command},
+    [VERB_SLOT('L', 'T', 4)] = {"LIST", 4, CMD_LIST, parse_list_command},
+    [VERB_SLOT('M', 'R', 7)] = {"MONITOR", 7, CMD_INVALID, parse_monitor_command},
+    [VERB_SLOT('S', 'N', 4)] = {"SCAN", 4, CMD_INVALID, parse_scan_command},
+    [VERB_SLOT('P', 'G', 4)] = {"PING", 4, CMD_PING, NULL},
+    [VERB_SLOT('Q', 'T', 4)] = {"QUIT", 4, CMD_QUIT, NULL},
+    [VERB_SLOT('S', 'P', 4)] = {"STOP", 4, CMD_STOP, NULL},
+    [VERB_SLOT('S', 'S', 5)] = {"STATS", 5, CMD_STATS, NULL},
+    [VERB_SLOT('S', 'T', 8)] = {"SNAPSHOT", 8, CMD_SNAPSHOT, NULL},
+    [VERB_SLOT('B', 'Y', 6)] = {"BINARY", 6, CMD_BINARY, NULL},
+};
+
+// Helper: O(1) verb lookup; returns NULL for unknown verbs
+static const verb_entry_t *verb_lookup(const char *verb, size_t len) {
+    if (len < 3 || len > 8) {
+        return NULL;
     }
+    unsigned slot = VERB_SLOT((unsigned char) verb[0], (unsigned char) verb[len - 1], len);
+    const verb_entry_t *entry = &g_verb_table[slot];
+    if (entry->verb == NULL || entry->len != len || memcmp(verb, entry->verb, len) != 0) {
+        return NULL;
+    }
+    return entry;
+}
 
-    // Split command and target
-    *colon = '\0';
-    const char *cmd_str = work;
-    const char *target_str = colon + 1;
-
-    // Parse command type
-    if (strcmp(cmd_str, "GET") == 0) {
-        cmd->type = CMD_GET;
-        strncpy(cmd->target, target_str, BEAMLINE_PV_NAME_MAX - 1);
-        cmd->target[BEAMLINE_PV_NAME_MAX - 1] = '\0';
-        return true;
+bool protocol_parse(char *input, cmd_t *cmd) {
+    if (input == NULL || cmd == NULL) {
+        return false;
     }
 
-    if (strcmp(cmd_str, "PUT") == 0) {
-        return parse_put_command(target_str, cmd);
+    // Initialize cmd
+    cmd->type = CMD_INVALID;
+    cmd->target = "";
+    cmd->value = 0.0;
+    cmd->has_value = false;
+    cmd->monitor_interval_ms = 0;
+    cmd->monitor_deadband = 0.0;
+    cmd->target_count = 0;
+
+    // Trim in place: advance past leading whitespace, truncate trailing
+    // whitespace and line endings. No bytes move.
+    while (*input == ' ' || *input == '\t' || *input == '\r') {
+        input++;
+    }
+    size_t len = strlen(input);
+    while (len > 0 && (input[len - 1] == '\n' || input[len - 1] == '\r' ||
+                       input[len - 1] == ' ' || input[len - 1] == '\t')) {
+        input[--len] = '\0';
     }
 
-    if (strcmp(cmd_str, "MOVE") == 0) {
-        return parse_move_command(target_str, cmd);
+    if (len == 0) {
+        return false;
     }
 
-    if (strcmp(cmd_str, "STATUS") == 0) {
-        cmd->type = CMD_STATUS;
-        strncpy(cmd->target, target_str, BEAMLINE_PV_NAME_MAX - 1);
-        cmd->target[BEAMLINE_PV_NAME_MAX - 1] = '\0';
-        return true;
+    // Split off the verb at the first colon and dispatch through the
+    // perfect-hash table; colon-less lines use the bare form (PING, ...)
+    char *colon = strchr(input, ':');
+    size_t verb_len = (colon != NULL) ? (size_t) (colon - input) : len;
+    const verb_entry_t *entry = verb_lookup(input, verb_len);
+    if (entry == NULL) {
+        return false;
     }
 
-    if (strcmp(cmd_str, "LIST") == 0) {
-        cmd->type = CMD_LIST;
-        if (target_str[0] != '\0') {
-            strncpy(cmd->target, target_str, BEAMLINE_PV_NAME_MAX - 1);
-            cmd->target[BEAMLINE_PV_NAME_MAX - 1] = '\0';
+    if (colon == NULL) {
+        if (entry->bare_type == CMD_INVALID) {
+            return false;
         }
+        cmd->type = entry->bare_type;
         return true;
     }
 
-    if (strcmp(cmd_str, "MONITOR") == 0) {
-        return parse_monitor_command(target_str, cmd);
+    if (entry->parse == NULL) {
+        return false;
     }
-
-    return false;
+    *colon = '\0';
+    return entry->parse(colon + 1, cmd);
 }
 
 void protocol_format_response(protocol_format_response_params_t params) {
@@ -0,0 +1,74 @@
+#include "rng.h"
+
+#include <math.h>
+
+// math.h only defines M_PI under feature-test macros; spell out 2*pi
+#define RNG_TWO_PI 6.283185307179586476925287
+
+// Helper: splitmix64 step, used only to expand seeds into full state so
+// nearby seeds (base + PV index) still yield decorrelated streams
+static uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+void rng_seed(rng_t *rng, uint64_t seed) {
+    rng->s[0] = splitmix64(&seed);
+    rng->s[1] = splitmix64(&seed);
+    rng->s[2] = splitmix64(&seed);
+    rng->s[3] = splitmix64(&seed);
+}
+
+uint64_t rng_next(rng_t *rng) {
+    uint64_t *s = rng->s;
+    uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+
+    return result;
+}
+
+double rng_uniform(rng_t *rng) {
+    // Top 53 bits give a uniform double in [0, 1)
+    return (double) (rng_next(rng) >> 11) * 0x1.0p-53;
+}
+
+void rng_fill_uniform(rng_t *rng, double *out, int n) {
+    for (int i = 0; i < n; i++) {
+        out[i] = (double) (rng_next(rng) >> 11) * 0x1.0p-53;
+    }
+}
+
+void rng_fill_gaussian(rng_t *rng, double *out, int n) {
+    // Box-Muller on pairs; the trailing odd sample discards its twin
+    for (int i = 0; i + 1 < n; i += 2) {
+        double u1 = rng_uniform(rng);
+        double u2 = rng_uniform(rng);
+        if (u1 < 0x1.0p-53) {
+            u1 = 0x1.0p-53; // Avoid log(0)
+        }
+        double r = sqrt(-2.0 * log(u1));
+        out[i] = r * cos(RNG_TWO_PI * u2);
+        out[i + 1] = r * sin(RNG_TWO_PI * u2);
+    }
+    if (n % 2 != 0) {
+        double u1 = rng_uniform(rng);
+        double u2 = rng_uniform(rng);
+        if (u1 < 0x1.0p-53) {
+            u1 = 0x1.0p-53;
+        }
+        out[n - 1] = sqrt(-2.0 * log(u1)) * cos(RNG_TWO_PI * u2);
+    }
+}
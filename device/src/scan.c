@@ -0,0 +1,223 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "scan.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "devices.h"
+#include "server.h"
+#include "utils.h"
+
+typedef enum {
+    SCAN_IDLE,
+    SCAN_TO_START,  // Moving the motor to the start position
+    SCAN_FLYING     // Flying start -> stop, emitting rows at sample crossings
+} scan_phase_t;
+
+typedef struct {
+    scan_phase_t phase;
+    int client_slot;
+    motor_t *motor;
+    pv_t *detectors[BEAMLINE_MAX_CMD_TARGETS];
+    int detector_count;
+    double start;
+    double stop;
+    double step;
+    double next_sample;  // Next position at which to emit a row
+    int direction;       // +1 or -1 along the trajectory
+    uint32_t move_gen;   // Motor generation before our queued move applies
+} scan_t;
+
+static scan_t g_scans[BEAMLINE_MAX_CLIENTS];
+
+static int64_t get_time_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t) ts.tv_sec * 1000) + ((int64_t) ts.tv_nsec / 1000000);
+}
+
+bool scan_begin(scan_begin_params_t params) {
+    if (params.client_slot < 0 || params.client_slot >= BEAMLINE_MAX_CLIENTS) {
+        return false;
+    }
+    if (params.detector_count < 1 || params.detector_count > BEAMLINE_MAX_CMD_TARGETS) {
+        return false;
+    }
+    if (params.step <= 0.0 || params.start == params.stop) {
+        return false;
+    }
+
+    scan_t *scan = &g_scans[params.client_slot];
+    if (scan->phase != SCAN_IDLE) {
+        return false; // One scan per client
+    }
+
+    motor_t *motor = motor_find(params.motor_pv);
+    if (motor == NULL || motor->setpoint == NULL || motor->readback == NULL) {
+        return false;
+    }
+    if (params.start < motor->setpoint->min || params.start > motor->setpoint->max ||
+        params.stop < motor->setpoint->min || params.stop > motor->setpoint->max) {
+        return false;
+    }
+
+    for (int i = 0; i < params.detector_count; i++) {
+        scan->detectors[i] = pv_find(params.detector_pvs[i]);
+        if (scan->detectors[i] == NULL) {
+            return false;
+        }
+    }
+
+    scan->client_slot = params.client_slot;
+    scan->motor = motor;
+    scan->detector_count = params.detector_count;
+    scan->start = params.start;
+    scan->stop = params.stop;
+    scan->step = params.step;
+    scan->direction = (params.stop > params.start) ? 1 : -1;
+    scan->next_sample = params.start;
+    scan->move_gen = motor_move_generation(motor);
+    scan->phase = SCAN_TO_START;
+
+    if (!devices_request_move(params.motor_pv, params.start)) {
+        scan->phase = SCAN_IDLE;
+        return false;
+    }
+
+    log_info("Scan started: %s %.6g -> %.6g step %.6g, %d detectors", params.motor_pv,
+             params.start, params.stop, params.step, params.detector_count);
+    return true;
+}
+
+// Helper: Emit one timestamped row at the current motor position
+static void scan_emit_row(scan_t *scan, int64_t now) {
+    char row[BEAMLINE_RESPONSE_BUFFER_SIZE];
+    size_t pos = 0;
+
+    int n = snprintf(row, sizeof(row), "ROW:%lld,", (long long) now);
+    if (n < 0) {
+        return;
+    }
+    pos = (size_t) n;
+    pos += fmt_double(row + pos, sizeof(row) - pos, pv_read(scan->motor->readback));
+
+    for (int i = 0; i < scan->detector_count; i++) {
+        if (pos + FMT_DOUBLE_MAX + 2 > sizeof(row)) {
+            break;
+        }
+        row[pos++] = ',';
+        pos += fmt_double(row + pos, sizeof(row) - pos, pv_read(scan->detectors[i]));
+    }
+    if (pos < sizeof(row) - 1) {
+        row[pos++] = '\n';
+    }
+    server_send(scan->client_slot, row, pos);
+}
+
+// Helper: True once the scan's queued move has been applied and finished.
+// devices_request_move() only enqueues: the motor's moving flag stays
+// false until the simulation tick drains the mailbox, so a bare !moving
+// check would declare arrival before the move even starts. The trajectory
+// generation advances when the move is applied, so "generation moved on
+// AND not moving" is arrival even if the motor starts and lands within
+// a single tick.
+static bool scan_move_arrived(const scan_t *scan) {
+    return motor_move_generation(scan->motor) != scan->move_gen && !scan->motor->moving;
+}
+
+// Helper: Advance one active scan
+static void scan_step_one(scan_t *scan, int64_t now) {
+    switch (scan->phase) {
+    case SCAN_TO_START:
+        if (scan_move_arrived(scan)) {
+            // At start position: launch the fly and begin sampling
+            scan->move_gen = motor_move_generation(scan->motor);
+            scan->phase = SCAN_FLYING;
+            if (!devices_request_move(scan->motor->setpoint->name, scan->stop)) {
+                scan->phase = SCAN_IDLE;
+                const char *err = "ERR:MOTOR_FAULT\n";
+                server_send(scan->client_slot, err, strlen(err));
+            }
+        }
+        break;
+
+    case SCAN_FLYING: {
+        double position = pv_read(scan->motor->readback);
+
+        // Emit a row for every sample position the motor crossed this tick
+        while ((scan->direction > 0 && position >= scan->next_sample - 1e-9) ||
+               (scan->direction < 0 && position <= scan->next_sample + 1e-9)) {
+            scan_emit_row(scan, now);
+            scan->next_sample += scan->step * scan->direction;
+            if ((scan->direction > 0 && scan->next_sample > scan->stop + 1e-9) ||
+                (scan->direction < 0 && scan->next_sample < scan->stop - 1e-9)) {
+                break;
+            }
+        }
+
+        if (scan_move_arrived(scan)) {
+            scan->phase = SCAN_IDLE;
+            const char *done = "OK:SCAN_DONE\n";
+            server_send(scan->client_slot, done, strlen(done));
+            log_info("Scan complete: %s", scan->motor->setpoint->name);
+        }
+        break;
+    }
+
+    case SCAN_IDLE:
+        break;
+    }
+}
+
+// Helper: Clamp a slot range to the scan table
+static void slot_range(int first_slot, int slot_count, int *first, int *last) {
+    *first = first_slot < 0 ? 0 : first_slot;
+    *last = first_slot + slot_count;
+    if (*last > BEAMLINE_MAX_CLIENTS) {
+        *last = BEAMLINE_MAX_CLIENTS;
+    }
+}
+
+void scan_service(int first_slot, int slot_count) {
+    int first;
+    int last;
+    slot_range(first_slot, slot_count, &first, &last);
+    int64_t now = get_time_ms();
+    for (int i = first; i < last; i++) {
+        if (g_scans[i].phase != SCAN_IDLE) {
+            scan_step_one(&g_scans[i], now);
+        }
+    }
+}
+
+void scan_abort(int client_slot) {
+    if (client_slot < 0 || client_slot >= BEAMLINE_MAX_CLIENTS) {
+        return;
+    }
+    g_scans[client_slot].phase = SCAN_IDLE;
+}
+
+bool scan_active(int client_slot) {
+    if (client_slot < 0 || client_slot >= BEAMLINE_MAX_CLIENTS) {
+        return false;
+    }
+    return g_scans[client_slot].phase != SCAN_IDLE;
+}
+
+bool scan_any_active(int first_slot, int slot_count) {
+    int first;
+    int last;
+    slot_range(first_slot, slot_count, &first, &last);
+    for (int i = first; i < last; i++) {
+        if (g_scans[i].phase != SCAN_IDLE) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -1,10 +1,18 @@
 #ifndef _POSIX_C_SOURCE
 #define _POSIX_C_SOURCE 200809L
 #endif
+// SO_REUSEPORT for the per-worker listeners
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
 
 #include "server.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -16,10 +24,15 @@
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <sys/un.h>
 
 #include "config.h"
 #include "devices.h"
+#include "event.h"
+#include "mcast.h"
 #include "protocol.h"
+#include "scan.h"
+#include "stats.h"
 #include "utils.h"
 
 typedef struct {
@@ -28,14 +41,73 @@ typedef struct {
     char recv_buf[BEAMLINE_CMD_BUFFER_SIZE];
     size_t recv_len;
     bool monitoring;
-    char monitor_pv[BEAMLINE_PV_NAME_MAX];
+    pv_handle_t monitor_pvs[BEAMLINE_MAX_CMD_TARGETS];
+    int monitor_pv_count;
     int monitor_interval_ms;
     int64_t last_monitor_time;
+    // Bitmap over monitor_pvs of updates that fired while this client was
+    // rate-limited; the dirty ring has already been drained by then, so
+    // parking them here is what keeps a step change from being lost
+    uint32_t monitor_pending;
+    // Buffered output: bytes [send_head, send_head + send_len) are pending.
+    // Compacted on enqueue; drained on write-readiness events.
+    char send_buf[BEAMLINE_SEND_QUEUE_SIZE];
+    size_t send_head;
+    size_t send_len;
+    // Raw GETW payload bytes are queued: the queue cannot be scanned for
+    // droppable line frames until it drains
+    bool send_has_raw;
+    // Command slice state: while corked, responses accumulate in the
+    // queue and go out in one send() when the slice ends; pending marks
+    // a burst that exhausted its budget and resumes next iteration
+    bool corked;
+    bool pending;
+    // Connection upgraded to the length-prefixed binary protocol (see
+    // protocol.h); recv_buf then holds frames instead of lines
+    bool binary;
 } client_t;
 
 static client_t g_clients[BEAMLINE_MAX_CLIENTS];
-static int g_client_count = 0;
-static int g_listen_fd = -1;
+static _Atomic int g_client_count = 0;
+static int g_unix_listen_fd = -1;
+
+// Sharded execution: each worker owns the client slots
+// [slot_base, slot_base + slot_count), its own event context and its own
+// SO_REUSEPORT listener (the kernel balances incoming connections across
+// them). Worker 0 runs on the caller's thread via server_run_once() and
+// additionally services the Unix listener and multicast; workers 1..N-1
+// run on their own threads until the stop pipe closes.
+typedef struct {
+    int id;
+    pthread_t thread;
+    bool thread_started;
+    event_ctx_t *events;
+    int listen_fd;
+    int slot_base;
+    int slot_count;
+    int rr_next; // Rotating start slot for fair burst resumption
+} worker_t;
+
+static worker_t g_workers[BEAMLINE_MAX_WORKERS];
+static int g_worker_count = 1;
+static int g_slots_per_worker = BEAMLINE_MAX_CLIENTS;
+static _Atomic bool g_workers_stop = false;
+static int g_stop_pipe[2] = {-1, -1};
+
+// Helper: The worker owning a client slot (the last worker takes the
+// remainder slots when the count does not divide evenly)
+static worker_t *slot_owner(int slot) {
+    int w = slot / g_slots_per_worker;
+    if (w >= g_worker_count) {
+        w = g_worker_count - 1;
+    }
+    return &g_workers[w];
+}
+
+// Helper: Event context of the worker owning a client
+static event_ctx_t *client_events(const client_t *client) {
+    return slot_owner((int) (client - g_clients))->events;
+}
 
 static int64_t get_time_ms(void) {
     struct timespec ts;
@@ -49,82 +121,458 @@ static void client_disconnect(client_t *client) {
     }
 
     log_info("Client disconnected (fd=%d)", client->fd);
+    pv_unsubscribe_all((int) (client - g_clients));
+    scan_abort((int) (client - g_clients));
+    event_del_fd(client_events(client), client->fd);
     close(client->fd);
     client->active = false;
     client->monitoring = false;
     client->recv_len = 0;
+    client->corked = false;
+    client->pending = false;
+    client->binary = false;
     g_client_count--;
 }
 
+// Helper: Does this frame start with a droppable (monitor/scan) prefix?
+static bool frame_droppable(const char *data, size_t len) {
+    return (len >= 5 && memcmp(data, "DATA:", 5) == 0) ||
+           (len >= 4 && memcmp(data, "ROW:", 4) == 0);
+}
+
+// Helper: Drop the oldest droppable frame from a compacted queue to make
+// room. The first queued line is never dropped: its head bytes may already
+// be on the wire. Returns true if a frame was removed.
+static bool sendq_drop_oldest(client_t *client) {
+    if (client->send_has_raw) {
+        return false; // Binary payload queued; newline scanning would misframe
+    }
+    size_t off = 0;
+    bool first = true;
+    while (off < client->send_len) {
+        char *line = client->send_buf + off;
+        size_t remain = client->send_len - off;
+        char *nl = memchr(line, '\n', remain);
+        size_t line_len = (nl != NULL) ? (size_t) (nl - line) + 1 : remain;
+
+        if (!first && frame_droppable(line, line_len)) {
+            memmove(line, line + line_len, remain - line_len);
+            client->send_len -= line_len;
+            return true;
+        }
+        first = false;
+        off += line_len;
+    }
+    return false;
+}
+
+// Helper: Queue data for a client, sending directly when possible. The
+// socket is non-blocking: a full kernel buffer queues the remainder and
+// arms write-readiness instead of stalling the event loop. On queue
+// overflow the oldest monitor/scan frames are dropped; a command response
+// that cannot be queued disconnects the stalled client.
+static void client_send(client_t *client, const char *data, size_t len) {
+    if (client == NULL || !client->active || len == 0) {
+        return;
+    }
+
+    // Fast path: nothing queued, try a direct send. Skipped while the
+    // client is mid-slice, so every response in the slice shares the
+    // one send() issued at uncork instead of a syscall per command.
+    size_t sent = 0;
+    if (client->send_len == 0 && !client->corked) {
+        ssize_t n = send(client->fd, data, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                log_error("send() failed: %s", strerror(errno));
+                client_disconnect(client);
+                return;
+            }
+        } else {
+            sent = (size_t) n;
+            stats_add_bytes_out(sent);
+        }
+        if (sent == len) {
+            return;
+        }
+    }
+
+    size_t need = len - sent;
+
+    // Compact so pending bytes start at offset 0
+    if (client->send_head > 0) {
+        memmove(client->send_buf, client->send_buf + client->send_head, client->send_len);
+        client->send_head = 0;
+    }
+
+    while (sizeof(client->send_buf) - client->send_len < need) {
+        if (!sendq_drop_oldest(client)) {
+            break;
+        }
+    }
+
+    if (sizeof(client->send_buf) - client->send_len < need) {
+        if (frame_droppable(data + sent, need)) {
+            log_warn("Client fd=%d slow consumer, dropping monitor frame", client->fd);
+            return;
+        }
+        log_warn("Client fd=%d output queue overflow, disconnecting", client->fd);
+        client_disconnect(client);
+        return;
+    }
+
+    memcpy(client->send_buf + client->send_len, data + sent, need);
+    client->send_len += need;
+    if (!client->corked) {
+        event_mod_fd(client_events(client), client->fd, true);
+    }
+}
+
+// Helper: Drain the output queue on a write-readiness event
+static void client_flush(client_t *client) {
+    while (client->send_len > 0) {
+        ssize_t n = send(client->fd, client->send_buf + client->send_head, client->send_len,
+                         MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return;
+            }
+            log_error("send() failed: %s", strerror(errno));
+            client_disconnect(client);
+            return;
+        }
+        stats_add_bytes_out((size_t) n);
+        client->send_head += (size_t) n;
+        client->send_len -= (size_t) n;
+    }
+    client->send_head = 0;
+    client->send_has_raw = false;
+    event_mod_fd(client_events(client), client->fd, false);
+}
+
+// Helper: End a command slice: everything its commands queued goes out
+// in one send(); whatever the kernel would not take stays queued with
+// write-readiness armed as usual
+static void client_uncork(client_t *client) {
+    client->corked = false;
+    if (!client->active || client->send_len == 0) {
+        return;
+    }
+    client_flush(client);
+    if (client->active && client->send_len > 0) {
+        event_mod_fd(client_events(client), client->fd, true);
+    }
+}
+
+// Helper: Format a DATA frame for a client. Single-PV monitors keep the
+// bare "DATA:<value>\n" form; multi-PV monitors get one coalesced
+// "DATA:PV1=v1,PV2=v2\n" frame so correlated channels share a packet.
+static size_t format_data_frame(const client_t *client, pv_t *const *pvs, int count, char *buf,
+                                size_t len) {
+    if (count <= 0 || len == 0) {
+        return 0;
+    }
+
+    if (len < 7 + FMT_DOUBLE_MAX) {
+        return 0;
+    }
+
+    // fmt_double writes values straight into the frame; no snprintf and
+    // no intermediate value string on this per-tick path
+    memcpy(buf, "DATA:", 5);
+    size_t pos = 5;
+
+    if (client->monitor_pv_count <= 1) {
+        pos += fmt_double(buf + pos, len - pos, pv_read(pvs[0]));
+        buf[pos++] = '\n';
+        buf[pos] = '\0';
+        return pos;
+    }
+
+    for (int i = 0; i < count; i++) {
+        size_t name_len = strlen(pvs[i]->name);
+        if (pos + name_len + FMT_DOUBLE_MAX + 3 > len) {
+            break;
+        }
+        if (i > 0) {
+            buf[pos++] = ',';
+        }
+        memcpy(buf + pos, pvs[i]->name, name_len);
+        pos += name_len;
+        buf[pos++] = '=';
+        pos += fmt_double(buf + pos, len - pos, pv_read(pvs[i]));
+    }
+    buf[pos++] = '\n';
+    buf[pos] = '\0';
+    return pos;
+}
+
 // Helper: Execute a parsed command and send response
 static void execute_command(client_t *client, const cmd_t *cmd) {
     char response[BEAMLINE_RESPONSE_BUFFER_SIZE];
 
     switch (cmd->type) {
     case CMD_GET: {
+        // Resolve the whole batch first; one unknown PV fails the command
+        pv_t *pvs[BEAMLINE_MAX_CMD_TARGETS];
+        bool all_known = cmd->target_count > 0;
+        for (int i = 0; i < cmd->target_count; i++) {
+            pvs[i] = pv_find(cmd->targets[i]);
+            if (pvs[i] == NULL) {
+                all_known = false;
+            }
+        }
+
+        if (!all_known) {
+            protocol_format_error((protocol_format_error_params_t) {
+                .buf = response, .len = sizeof(response), .err_code = ERR_UNKNOWN_PV});
+        } else {
+            // All values in one response line, emitted directly into the
+            // outgoing buffer: OK:v1,v2,...
+            memcpy(response, "OK:", 3);
+            size_t pos = 3;
+            for (int i = 0; i < cmd->target_count; i++) {
+                if (pos + FMT_DOUBLE_MAX + 2 > sizeof(response)) {
+                    break;
+                }
+                if (i > 0) {
+                    response[pos++] = ',';
+                }
+                pos += fmt_double(response + pos, sizeof(response) - pos, pv_read(pvs[i]));
+            }
+            response[pos++] = '\n';
+            response[pos] = '\0';
+        }
+        client_send(client, response, strlen(response));
+        break;
+    }
+
+    case CMD_GETW: {
         pv_t *pv = pv_find(cmd->target);
         if (pv == NULL) {
             protocol_format_error((protocol_format_error_params_t) {
                 .buf = response, .len = sizeof(response), .err_code = ERR_UNKNOWN_PV});
-        } else {
-            char value_str[64];
-            snprintf(value_str, sizeof(value_str), "%.6g", pv_get(pv));
-            protocol_format_response((protocol_format_response_params_t) {
-                .buf = response, .len = sizeof(response), .status = "OK", .data = value_str});
+            client_send(client, response, strlen(response));
+            break;
+        }
+        if (pv->nelem == 0) {
+            // Scalar PV: no binary path, use GET
+            protocol_format_error((protocol_format_error_params_t) {
+                .buf = response, .len = sizeof(response), .err_code = ERR_INVALID_VALUE});
+            client_send(client, response, strlen(response));
+            break;
+        }
+
+        // Length-prefixed binary transfer: "WAVE:<count>\n" followed by
+        // count host-order doubles straight from the snapshot — no per-
+        // element text formatting
+        double wave[BEAMLINE_WAVEFORM_MAX_ELEMENTS];
+        int count = pv_read_wave(pv, wave, BEAMLINE_WAVEFORM_MAX_ELEMENTS);
+        int n = snprintf(response, sizeof(response), "WAVE:%d\n", count);
+        client_send(client, response, (size_t) n);
+        client_send(client, (const char *) wave, (size_t) count * sizeof(double));
+        if (client->active && client->send_len > 0) {
+            client->send_has_raw = true;
         }
-        send(client->fd, response, strlen(response), 0);
         break;
     }
 
-    case CMD_PUT: {
+    case CMD_GETHIST: {
         pv_t *pv = pv_find(cmd->target);
         if (pv == NULL) {
             protocol_format_error((protocol_format_error_params_t) {
                 .buf = response, .len = sizeof(response), .err_code = ERR_UNKNOWN_PV});
-        } else if (!pv_set(pv, cmd->value)) {
+            client_send(client, response, strlen(response));
+            break;
+        }
+        if (pv->hist_depth == 0) {
+            // No history ring registered for this PV
             protocol_format_error((protocol_format_error_params_t) {
                 .buf = response, .len = sizeof(response), .err_code = ERR_INVALID_VALUE});
+            client_send(client, response, strlen(response));
+            break;
+        }
+
+        // Same binary framing as GETW: "HIST:<count>\n" followed by count
+        // (t_ms, value) host-order double pairs, oldest first
+        pv_hist_sample_t samples[BEAMLINE_HISTORY_MAX_SAMPLES];
+        int want = (int) cmd->value;
+        if (want > BEAMLINE_HISTORY_MAX_SAMPLES) {
+            want = BEAMLINE_HISTORY_MAX_SAMPLES;
+        }
+        int count = pv_read_hist(pv, samples, want);
+        int n = snprintf(response, sizeof(response), "HIST:%d\n", count);
+        client_send(client, response, (size_t) n);
+        client_send(client, (const char *) samples, (size_t) count * sizeof(samples[0]));
+        if (client->active && client->send_len > 0) {
+            client->send_has_raw = true;
+        }
+        break;
+    }
+
+    case CMD_SNAPSHOT: {
+        // Whole PV table in one round trip: "SNAPSHOT:<count>\n" then one
+        // preformatted name=value line per PV (cached per tick; no
+        // per-request formatting)
+        const char *text;
+        int count = 0;
+        size_t text_len = pv_snapshot_text(&text, &count);
+        int n = snprintf(response, sizeof(response), "SNAPSHOT:%d\n", count);
+        client_send(client, response, (size_t) n);
+        if (text_len > 0) {
+            client_send(client, text, text_len);
+        }
+        pv_snapshot_release();
+        break;
+    }
+
+    case CMD_PUT: {
+        // Validate every assignment before applying any, so a batched PUT
+        // is all-or-nothing
+        pv_t *pvs[BEAMLINE_MAX_CMD_TARGETS];
+        int err = -1;
+        for (int i = 0; i < cmd->target_count; i++) {
+            pvs[i] = pv_find(cmd->targets[i]);
+            if (pvs[i] == NULL) {
+                err = ERR_UNKNOWN_PV;
+                break;
+            }
+            if (!pvs[i]->writable || cmd->values[i] < pvs[i]->min ||
+                cmd->values[i] > pvs[i]->max) {
+                err = ERR_INVALID_VALUE;
+                break;
+            }
+        }
+        if (cmd->target_count == 0) {
+            err = ERR_INVALID_VALUE;
+        }
+
+        if (err == -1) {
+            // Hand the writes to the simulation thread
+            for (int i = 0; i < cmd->target_count; i++) {
+                if (!devices_request_put(pvs[i], cmd->values[i])) {
+                    err = ERR_INTERNAL;
+                    break;
+                }
+            }
+        }
+
+        if (err != -1) {
+            protocol_format_error((protocol_format_error_params_t) {
+                .buf = response, .len = sizeof(response), .err_code = (error_code_t) err});
         } else {
             protocol_format_response((protocol_format_response_params_t) {
                 .buf = response, .len = sizeof(response), .status = "OK", .data = "PUT"});
         }
-        send(client->fd, response, strlen(response), 0);
+        client_send(client, response, strlen(response));
         break;
     }
 
     case CMD_PING:
         protocol_format_response((protocol_format_response_params_t) {
             .buf = response, .len = sizeof(response), .status = "OK", .data = "PONG"});
-        send(client->fd, response, strlen(response), 0);
+        client_send(client, response, strlen(response));
+        break;
+
+    case CMD_BINARY:
+        // Last text line on this connection; everything after is frames
+        protocol_format_response((protocol_format_response_params_t) {
+            .buf = response, .len = sizeof(response), .status = "OK", .data = "BINARY"});
+        client_send(client, response, strlen(response));
+        client->binary = true;
         break;
 
     case CMD_QUIT:
         protocol_format_response((protocol_format_response_params_t) {
             .buf = response, .len = sizeof(response), .status = "OK", .data = "BYE"});
-        send(client->fd, response, strlen(response), 0);
+        client_send(client, response, strlen(response));
+        // Push out responses corked earlier in this slice before the
+        // socket goes away (best effort; the peer is leaving anyway)
+        if (client->corked) {
+            client_uncork(client);
+        }
         client_disconnect(client);
         return;
 
-    case CMD_MONITOR:
-        client->monitoring = true;
-        {
-            size_t len = strlen(cmd->target);
-            size_t copy_len = len < BEAMLINE_PV_NAME_MAX - 1 ? len : BEAMLINE_PV_NAME_MAX - 1;
-            memcpy(client->monitor_pv, cmd->target, copy_len);
-            client->monitor_pv[copy_len] = '\0';
+    case CMD_MONITOR: {
+        // Validate the whole target list before subscribing to any of it
+        pv_handle_t handles[BEAMLINE_MAX_CMD_TARGETS];
+        bool all_known = cmd->target_count > 0;
+        for (int i = 0; i < cmd->target_count; i++) {
+            handles[i] = pv_handle(cmd->targets[i]);
+            if (handles[i] == PV_HANDLE_INVALID) {
+                all_known = false;
+            }
         }
+        if (!all_known) {
+            protocol_format_error((protocol_format_error_params_t) {
+                .buf = response, .len = sizeof(response), .err_code = ERR_UNKNOWN_PV});
+            client_send(client, response, strlen(response));
+            break;
+        }
+
+        client->monitoring = true;
+        client->monitor_pv_count = cmd->target_count;
         client->monitor_interval_ms = cmd->monitor_interval_ms;
-        client->last_monitor_time = get_time_ms();
+        client->last_monitor_time = 0;
+        client->monitor_pending = 0;
+        int slot = (int) (client - g_clients);
+        for (int i = 0; i < cmd->target_count; i++) {
+            client->monitor_pvs[i] = handles[i];
+            pv_subscribe(pv_from_handle(handles[i]), slot, cmd->monitor_deadband);
+        }
         protocol_format_response((protocol_format_response_params_t) {
             .buf = response, .len = sizeof(response), .status = "OK", .data = "MONITORING"});
-        send(client->fd, response, strlen(response), 0);
+        client_send(client, response, strlen(response));
+
+        // Send the current values right away so slow PVs don't leave the
+        // subscriber without data until the first change
+        pv_t *pvs[BEAMLINE_MAX_CMD_TARGETS];
+        for (int i = 0; i < cmd->target_count; i++) {
+            pvs[i] = pv_from_handle(handles[i]);
+        }
+        char data_msg[BEAMLINE_RESPONSE_BUFFER_SIZE];
+        size_t msg_len =
+            format_data_frame(client, pvs, cmd->target_count, data_msg, sizeof(data_msg));
+        client_send(client, data_msg, msg_len);
+        client->last_monitor_time = get_time_ms();
+        break;
+    }
+
+    case CMD_STATS: {
+        // Send-queue gauge covers this worker's own shard only (other
+        // workers' buffers are not safe to read); dirty depth sums every
+        // worker's ring
+        const worker_t *w = slot_owner((int) (client - g_clients));
+        size_t sendq = 0;
+        for (int i = w->slot_base; i < w->slot_base + w->slot_count; i++) {
+            if (g_clients[i].active) {
+                sendq += g_clients[i].send_len;
+            }
+        }
+        int dirty = 0;
+        for (int i = 0; i < g_worker_count; i++) {
+            dirty += pv_dirty_depth(i);
+        }
+        char payload[BEAMLINE_RESPONSE_BUFFER_SIZE - 8]; // Room for "OK:" + "\n"
+        stats_format((stats_format_params_t) {.buf = payload,
+                                              .len = sizeof(payload),
+                                              .clients = atomic_load(&g_client_count),
+                                              .sendq_bytes = sendq,
+                                              .dirty_depth = dirty});
+        protocol_format_response((protocol_format_response_params_t) {
+            .buf = response, .len = sizeof(response), .status = "OK", .data = payload});
+        client_send(client, response, strlen(response));
         break;
+    }
 
     case CMD_STOP:
         client->monitoring = false;
+        client->monitor_pv_count = 0;
+        pv_unsubscribe_all((int) (client - g_clients));
         protocol_format_response((protocol_format_response_params_t) {
             .buf = response, .len = sizeof(response), .status = "OK", .data = "STOPPED"});
-        send(client->fd, response, strlen(response), 0);
+        client_send(client, response, strlen(response));
         break;
 
     case CMD_LIST: {
@@ -138,19 +586,40 @@ static void execute_command(client_t *client, const cmd_t *cmd) {
             protocol_format_response((protocol_format_response_params_t) {
                 .buf = response, .len = sizeof(response), .status = "OK", .data = ""});
         }
-        send(client->fd, response, strlen(response), 0);
+        client_send(client, response, strlen(response));
         break;
     }
 
     case CMD_MOVE: {
-        if (!motor_move(cmd->target, cmd->value)) {
+        if (!devices_request_move(cmd->target, cmd->value)) {
             protocol_format_error((protocol_format_error_params_t) {
                 .buf = response, .len = sizeof(response), .err_code = ERR_INVALID_VALUE});
         } else {
             protocol_format_response((protocol_format_response_params_t) {
                 .buf = response, .len = sizeof(response), .status = "OK", .data = "MOVING"});
         }
-        send(client->fd, response, strlen(response), 0);
+        client_send(client, response, strlen(response));
+        break;
+    }
+
+    case CMD_SCAN: {
+        bool ok = scan_begin((scan_begin_params_t) {
+            .client_slot = (int) (client - g_clients),
+            .motor_pv = cmd->targets[0],
+            .detector_pvs = &cmd->targets[1],
+            .detector_count = cmd->target_count - 1,
+            .start = cmd->scan_start,
+            .stop = cmd->scan_stop,
+            .step = cmd->scan_step,
+        });
+        if (!ok) {
+            protocol_format_error((protocol_format_error_params_t) {
+                .buf = response, .len = sizeof(response), .err_code = ERR_INVALID_VALUE});
+        } else {
+            protocol_format_response((protocol_format_response_params_t) {
+                .buf = response, .len = sizeof(response), .status = "OK", .data = "SCANNING"});
+        }
+        client_send(client, response, strlen(response));
         break;
     }
 
@@ -164,79 +633,312 @@ static void execute_command(client_t *client, const cmd_t *cmd) {
             protocol_format_response((protocol_format_response_params_t) {
                 .buf = response, .len = sizeof(response), .status = "OK", .data = status_str});
         }
-        send(client->fd, response, strlen(response), 0);
+        client_send(client, response, strlen(response));
         break;
     }
 
     default:
         protocol_format_error((protocol_format_error_params_t) {
             .buf = response, .len = sizeof(response), .err_code = ERR_UNKNOWN_CMD});
-        send(client->fd, response, strlen(response), 0);
+        client_send(client, response, strlen(response));
         break;
     }
 }
 
-static void client_handle(client_t *client) {
-    if (client == NULL || !client->active) {
+// Helper: Queue one binary-mode response frame (see protocol.h):
+// uint32 len | uint8 opcode | uint8 status | payload
+static void binary_respond(client_t *client, uint8_t opcode, uint8_t status,
+                           const void *payload, size_t payload_len) {
+    uint8_t frame[4 + 2 + 16];
+    uint32_t len = (uint32_t) (2 + payload_len);
+    memcpy(frame, &len, sizeof(len));
+    frame[4] = opcode;
+    frame[5] = status;
+    if (payload_len > 0) {
+        memcpy(frame + 6, payload, payload_len);
+    }
+    client_send(client, (const char *) frame, 4 + 2 + payload_len);
+}
+
+// Helper: Execute one binary frame. Fixed layouts per opcode, so
+// decoding is a length check and a memcpy; a PV arrives as the uint32
+// handle interned by BIN_OP_RESOLVE. Status is 0 or error_code_t + 1.
+static void execute_binary(client_t *client, uint8_t opcode, const char *payload,
+                           size_t len) {
+    switch (opcode) {
+    case BIN_OP_RESOLVE: {
+        char name[BEAMLINE_PV_NAME_MAX];
+        if (len == 0 || len >= sizeof(name)) {
+            binary_respond(client, opcode, ERR_UNKNOWN_PV + 1, NULL, 0);
+            return;
+        }
+        memcpy(name, payload, len);
+        name[len] = '\0';
+        pv_handle_t handle = pv_handle(name);
+        if (handle == PV_HANDLE_INVALID) {
+            binary_respond(client, opcode, ERR_UNKNOWN_PV + 1, NULL, 0);
+            return;
+        }
+        uint32_t out = (uint32_t) handle;
+        binary_respond(client, opcode, 0, &out, sizeof(out));
         return;
     }
 
-    // Read data
-    ssize_t n = recv(client->fd, client->recv_buf + client->recv_len,
-                     BEAMLINE_CMD_BUFFER_SIZE - client->recv_len - 1, MSG_DONTWAIT);
+    case CMD_GET: {
+        uint32_t handle;
+        if (len != sizeof(handle)) {
+            binary_respond(client, opcode, ERR_UNKNOWN_CMD + 1, NULL, 0);
+            return;
+        }
+        memcpy(&handle, payload, sizeof(handle));
+        pv_t *pv = pv_from_handle((pv_handle_t) handle);
+        if (pv == NULL) {
+            binary_respond(client, opcode, ERR_UNKNOWN_PV + 1, NULL, 0);
+            return;
+        }
+        double value = pv_read(pv);
+        binary_respond(client, opcode, 0, &value, sizeof(value));
+        return;
+    }
 
-    if (n < 0) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            // No data available, return (monitoring handled separately)
+    case CMD_PUT: {
+        uint32_t handle;
+        double value;
+        if (len != sizeof(handle) + sizeof(value)) {
+            binary_respond(client, opcode, ERR_UNKNOWN_CMD + 1, NULL, 0);
             return;
         }
-        log_error("recv() failed: %s", strerror(errno));
-        client_disconnect(client);
+        memcpy(&handle, payload, sizeof(handle));
+        memcpy(&value, payload + sizeof(handle), sizeof(value));
+        pv_t *pv = pv_from_handle((pv_handle_t) handle);
+        if (pv == NULL) {
+            binary_respond(client, opcode, ERR_UNKNOWN_PV + 1, NULL, 0);
+            return;
+        }
+        if (!pv->writable || value < pv->min || value > pv->max) {
+            binary_respond(client, opcode, ERR_INVALID_VALUE + 1, NULL, 0);
+            return;
+        }
+        if (!devices_request_put(pv, value)) {
+            binary_respond(client, opcode, ERR_INTERNAL + 1, NULL, 0);
+            return;
+        }
+        binary_respond(client, opcode, 0, NULL, 0);
         return;
     }
 
-    if (n == 0) {
-        // Connection closed
+    case CMD_MOVE: {
+        uint32_t handle;
+        double target;
+        if (len != sizeof(handle) + sizeof(target)) {
+            binary_respond(client, opcode, ERR_UNKNOWN_CMD + 1, NULL, 0);
+            return;
+        }
+        memcpy(&handle, payload, sizeof(handle));
+        memcpy(&target, payload + sizeof(handle), sizeof(target));
+        pv_t *pv = pv_from_handle((pv_handle_t) handle);
+        if (pv == NULL) {
+            binary_respond(client, opcode, ERR_UNKNOWN_PV + 1, NULL, 0);
+            return;
+        }
+        if (!devices_request_move(pv->name, target)) {
+            binary_respond(client, opcode, ERR_INVALID_VALUE + 1, NULL, 0);
+            return;
+        }
+        binary_respond(client, opcode, 0, NULL, 0);
+        return;
+    }
+
+    case CMD_PING:
+        binary_respond(client, opcode, 0, NULL, 0);
+        return;
+
+    case CMD_QUIT:
+        binary_respond(client, opcode, 0, NULL, 0);
+        if (client->corked) {
+            client_uncork(client);
+        }
         client_disconnect(client);
         return;
+
+    default:
+        binary_respond(client, opcode, ERR_UNKNOWN_CMD + 1, NULL, 0);
+        return;
     }
+}
 
-    if (n > 0) {
-        client->recv_len += (size_t) n;
-        client->recv_buf[client->recv_len] = '\0';
+// Helper: Drain complete binary frames from the receive buffer, under
+// the same slice budget and corked single-send as the text path
+static void client_process_binary(client_t *client) {
+    client->pending = false;
+    client->corked = true;
+    int budget = BEAMLINE_CMD_BUDGET;
+
+    size_t offset = 0;
+    while (budget > 0 && client->recv_len - offset >= 4) {
+        uint32_t len;
+        memcpy(&len, client->recv_buf + offset, sizeof(len));
+        if (len < 1 || len > BEAMLINE_BIN_MAX_FRAME) {
+            log_warn("Client fd=%d sent malformed binary frame, disconnecting",
+                     client->fd);
+            client_disconnect(client);
+            return;
+        }
+        if (client->recv_len - offset - 4 < len) {
+            break; // Partial frame; wait for the rest
+        }
+
+        uint64_t t_exec = stats_now_ns();
+        uint8_t opcode = (uint8_t) client->recv_buf[offset + 4];
+        execute_binary(client, opcode, client->recv_buf + offset + 5, len - 1);
+        stats_record(opcode < CMD_INVALID
+                         ? (stats_class_t) (STAT_EXEC_FIRST + opcode)
+                         : (stats_class_t) (STAT_EXEC_FIRST + CMD_BINARY),
+                     stats_now_ns() - t_exec);
+        if (!client->active) {
+            return; // QUIT disconnected the client
+        }
+        offset += 4 + len;
+        budget--;
+    }
+
+    if (offset > 0) {
+        size_t remaining = client->recv_len - offset;
+        if (remaining > 0) {
+            memmove(client->recv_buf, client->recv_buf + offset, remaining);
+        }
+        client->recv_len = remaining;
+    }
+
+    // A complete frame left over means the budget ran out mid-burst
+    if (client->recv_len >= 4) {
+        uint32_t len;
+        memcpy(&len, client->recv_buf, sizeof(len));
+        if (client->recv_len - 4 >= len) {
+            client->pending = true;
+        }
     }
+    client_uncork(client);
+}
 
-    // Process complete lines
-    char *line_start = client->recv_buf;
-    while (true) {
-        char *newline = strchr(line_start, '\n');
+// Helper: Parse and execute the client's buffered complete lines, up to
+// BEAMLINE_CMD_BUDGET per slice. Responses are corked into one send();
+// a pipelined burst that exhausts the budget is marked pending and
+// resumes next loop iteration, so other clients get a turn in between.
+static void client_process(client_t *client) {
+    if (client->binary) {
+        client_process_binary(client);
+        return;
+    }
+
+    client->pending = false;
+    client->corked = true;
+    int budget = BEAMLINE_CMD_BUDGET;
+
+    // Process complete lines in place: protocol_parse tokenizes each line
+    // inside recv_buf (cmd_t points into it), and a read offset tracks
+    // consumed bytes instead of a memmove per line
+    size_t offset = 0;
+    while (offset < client->recv_len && budget > 0) {
+        char *line_start = client->recv_buf + offset;
+        char *newline = memchr(line_start, '\n', client->recv_len - offset);
         if (newline == NULL) {
             break;
         }
 
         *newline = '\0';
         cmd_t cmd;
-        if (protocol_parse(line_start, &cmd)) {
+        uint64_t t_parse = stats_now_ns();
+        bool parsed = protocol_parse(line_start, &cmd);
+        uint64_t t_exec = stats_now_ns();
+        stats_record(STAT_PARSE, t_exec - t_parse);
+        if (parsed) {
             execute_command(client, &cmd);
+            stats_record((stats_class_t) (STAT_EXEC_FIRST + cmd.type),
+                         stats_now_ns() - t_exec);
+            if (!client->active) {
+                return; // QUIT disconnected the client; buffer is gone
+            }
         } else {
             char response[BEAMLINE_RESPONSE_BUFFER_SIZE];
             protocol_format_error((protocol_format_error_params_t) {
                 .buf = response, .len = sizeof(response), .err_code = ERR_UNKNOWN_CMD});
-            send(client->fd, response, strlen(response), 0);
+            client_send(client, response, strlen(response));
+        }
+
+        offset = (size_t) (newline - client->recv_buf) + 1;
+        budget--;
+        if (client->binary) {
+            break; // BINARY upgrade: the rest of the buffer is frames
         }
+    }
 
-        // Move remaining data to start
-        size_t remaining = client->recv_len - (newline - client->recv_buf) - 1;
+    // One compaction per slice: keep only the unconsumed tail
+    if (offset > 0) {
+        size_t remaining = client->recv_len - offset;
         if (remaining > 0) {
-            memmove(client->recv_buf, newline + 1, remaining);
+            memmove(client->recv_buf, client->recv_buf + offset, remaining);
         }
         client->recv_len = remaining;
-        line_start = client->recv_buf;
+        client->recv_buf[client->recv_len] = '\0';
+    }
+
+    if (client->binary) {
+        // Frames pipelined behind the upgrade command execute right away
+        client_uncork(client);
+        if (client->recv_len > 0) {
+            client_process_binary(client);
+        }
+        return;
+    }
+
+    // A complete line left over means the budget ran out mid-burst
+    if (memchr(client->recv_buf, '\n', client->recv_len) != NULL) {
+        client->pending = true;
     }
+    client_uncork(client);
 }
 
-static void client_accept(int listen_fd) {
-    struct sockaddr_in client_addr;
+static void client_handle(client_t *client) {
+    if (client == NULL || !client->active) {
+        return;
+    }
+
+    // Buffer full of budget-deferred lines: let the resume path drain it
+    // before reading more (an overlong single line still reads 0 below)
+    if (client->pending && client->recv_len >= BEAMLINE_CMD_BUFFER_SIZE - 1) {
+        return;
+    }
+
+    // Read data
+    ssize_t n = recv(client->fd, client->recv_buf + client->recv_len,
+                     BEAMLINE_CMD_BUFFER_SIZE - client->recv_len - 1, MSG_DONTWAIT);
+
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // No data available, return (monitoring handled separately)
+            return;
+        }
+        log_error("recv() failed: %s", strerror(errno));
+        client_disconnect(client);
+        return;
+    }
+
+    if (n == 0) {
+        // Connection closed
+        client_disconnect(client);
+        return;
+    }
+
+    stats_add_bytes_in((size_t) n);
+    client->recv_len += (size_t) n;
+    client->recv_buf[client->recv_len] = '\0';
+
+    client_process(client);
+}
+
+static void client_accept(worker_t *worker, int listen_fd) {
+    struct sockaddr_storage client_addr;
     socklen_t addr_len = sizeof(client_addr);
 
     int client_fd = accept(listen_fd, (struct sockaddr *) &client_addr, &addr_len);
@@ -247,9 +949,9 @@ static void client_accept(int listen_fd) {
         return;
     }
 
-    // Find free slot
+    // Find a free slot in this worker's shard
     int slot = -1;
-    for (int i = 0; i < BEAMLINE_MAX_CLIENTS; i++) {
+    for (int i = worker->slot_base; i < worker->slot_base + worker->slot_count; i++) {
         if (!g_clients[i].active) {
             slot = i;
             break;
@@ -257,7 +959,15 @@ static void client_accept(int listen_fd) {
     }
 
     if (slot < 0) {
-        log_warn("Max clients reached, rejecting connection");
+        log_warn("Worker %d shard full, rejecting connection", worker->id);
+        close(client_fd);
+        return;
+    }
+
+    // Non-blocking socket: the buffered send path must never stall the loop
+    int flags = fcntl(client_fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(client_fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        log_error("fcntl(O_NONBLOCK) failed: %s", strerror(errno));
         close(client_fd);
         return;
     }
@@ -268,130 +978,453 @@ static void client_accept(int listen_fd) {
     client->active = true;
     client->recv_len = 0;
     client->monitoring = false;
-    client->monitor_pv[0] = '\0';
+    client->monitor_pv_count = 0;
     client->monitor_interval_ms = 0;
     client->last_monitor_time = 0;
+    client->monitor_pending = 0;
+    client->send_head = 0;
+    client->send_len = 0;
+    client->send_has_raw = false;
+    client->corked = false;
+    client->pending = false;
+    client->binary = false;
     g_client_count++;
 
-    log_info("Client connected (fd=%d, addr=%s)", client_fd, inet_ntoa(client_addr.sin_addr));
+    if (event_add_fd(worker->events, client_fd) < 0) {
+        log_error("Failed to register client fd=%d with event backend", client_fd);
+        client_disconnect(client);
+        return;
+    }
+
+    // Unix-domain peers have no meaningful address to print
+    char ip_str[INET_ADDRSTRLEN] = "unix";
+    if (client_addr.ss_family == AF_INET) {
+        inet_ntop(AF_INET, &((struct sockaddr_in *) &client_addr)->sin_addr, ip_str,
+                  sizeof(ip_str));
+    }
+    log_info("Client connected (fd=%d, addr=%s)", client_fd, ip_str);
 }
 
-int server_init(void) {
-    g_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (g_listen_fd < 0) {
+// Helper: Bind the Unix-domain listener for co-located clients (same
+// line protocol as TCP, minus the network stack). Owned by worker 0.
+// Failure is non-fatal: the TCP listeners serve everything.
+static int unix_listener_init(event_ctx_t *events) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        log_warn("Unix socket unavailable: %s", strerror(errno));
+        return -1;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, BEAMLINE_UNIX_SOCKET_PATH, sizeof(addr.sun_path) - 1);
+
+    unlink(BEAMLINE_UNIX_SOCKET_PATH); // Stale path from a previous run
+    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+        listen(fd, BEAMLINE_BACKLOG) < 0) {
+        log_warn("Unix listener on %s failed: %s", BEAMLINE_UNIX_SOCKET_PATH, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    if (event_add_fd(events, fd) < 0) {
+        log_warn("Failed to register unix listen fd with event backend");
+        close(fd);
+        unlink(BEAMLINE_UNIX_SOCKET_PATH);
+        return -1;
+    }
+
+    log_info("Listening on unix socket %s", BEAMLINE_UNIX_SOCKET_PATH);
+    return fd;
+}
+
+// Helper: Bind one TCP listener. Every worker binds its own with
+// SO_REUSEPORT so the kernel balances incoming connections across the
+// workers' accept queues with no handoff between threads.
+static int tcp_listener_init(void) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
         log_error("socket() failed: %s", strerror(errno));
         return -1;
     }
 
-    // Set SO_REUSEADDR
     int opt = 1;
-    if (setsockopt(g_listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
         log_error("setsockopt() failed: %s", strerror(errno));
-        close(g_listen_fd);
+        close(fd);
         return -1;
     }
 
-    // Bind
     struct sockaddr_in addr;
     memset(&addr, 0, sizeof(addr));
     addr.sin_family = AF_INET;
     addr.sin_addr.s_addr = INADDR_ANY;
     addr.sin_port = htons(BEAMLINE_PORT);
 
-    if (bind(g_listen_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
         log_error("bind() failed: %s", strerror(errno));
-        close(g_listen_fd);
+        close(fd);
         return -1;
     }
 
-    // Listen
-    if (listen(g_listen_fd, BEAMLINE_BACKLOG) < 0) {
+    if (listen(fd, BEAMLINE_BACKLOG) < 0) {
         log_error("listen() failed: %s", strerror(errno));
-        close(g_listen_fd);
+        close(fd);
         return -1;
     }
 
-    // Initialize client array
-    for (int i = 0; i < BEAMLINE_MAX_CLIENTS; i++) {
-        g_clients[i].active = false;
-    }
-    g_client_count = 0;
+    return fd;
+}
 
-    return g_listen_fd;
+// Helper: Find the client owning a ready fd within one worker's shard
+static client_t *client_for_fd(const worker_t *worker, int fd) {
+    for (int i = worker->slot_base; i < worker->slot_base + worker->slot_count; i++) {
+        if (g_clients[i].active && g_clients[i].fd == fd) {
+            return &g_clients[i];
+        }
+    }
+    return NULL;
 }
 
-// Helper: Setup select() file descriptor set
-static void setup_select_fds(int listen_fd, fd_set *read_fds, int *max_fd) {
-    FD_ZERO(read_fds);
-    FD_SET(listen_fd, read_fds);
-    *max_fd = listen_fd;
+// Helper: Drain this worker's dirty ring and notify only its own
+// subscribers. The monitor interval acts as a per-client rate limit
+// rather than a polling period. All of a client's PVs that fired in the
+// same tick are coalesced into one DATA frame (one send(), one packet).
+// Taking the dirty ring consumes the notification -- the sim thread has
+// already advanced its notified value -- so updates that land while a
+// client is rate-limited are parked in the client's pending bitmap and
+// delivered when its interval elapses, not dropped. A PV that steps once
+// and then sits still (a shutter toggle, say) thus always reaches the
+// client eventually.
+static void check_monitoring(const worker_t *worker) {
+    pv_t *dirty[BEAMLINE_MAX_PVS];
+    int ndirty = pv_take_dirty(worker->id, dirty, BEAMLINE_MAX_PVS);
 
-    // Add all client FDs
-    for (int i = 0; i < BEAMLINE_MAX_CLIENTS; i++) {
-        if (g_clients[i].active) {
-            FD_SET(g_clients[i].fd, read_fds);
-            if (g_clients[i].fd > *max_fd) {
-                *max_fd = g_clients[i].fd;
+    // Park pass: record each dirty PV in every affected client's pending
+    // bitmap (indexed by the PV's slot in the client's monitor list)
+    if (ndirty > 0) {
+        // Union of this shard's subscribers across all dirty PVs
+        uint32_t shard_mask = 0;
+        for (int i = worker->slot_base; i < worker->slot_base + worker->slot_count; i++) {
+            shard_mask |= (uint32_t) 1 << i;
+        }
+        uint32_t affected = 0;
+        for (int d = 0; d < ndirty; d++) {
+            affected |= dirty[d]->subscribers & shard_mask;
+        }
+
+        while (affected != 0) {
+            int slot = __builtin_ctz(affected);
+            affected &= affected - 1;
+
+            client_t *client = &g_clients[slot];
+            if (!client->active || !client->monitoring) {
+                continue;
+            }
+            for (int j = 0; j < client->monitor_pv_count; j++) {
+                const pv_t *pv = pv_from_handle(client->monitor_pvs[j]);
+                for (int d = 0; d < ndirty; d++) {
+                    if (dirty[d] == pv) {
+                        client->monitor_pending |= (uint32_t) 1 << j;
+                        break;
+                    }
+                }
             }
         }
     }
-}
 
-// Helper: Check and send monitoring updates
-static void check_monitoring(void) {
-    for (int i = 0; i < BEAMLINE_MAX_CLIENTS; i++) {
-        if ((int) g_clients[i].active && (int) g_clients[i].monitoring) {
-            int64_t now = get_time_ms();
-            if (now - g_clients[i].last_monitor_time >= g_clients[i].monitor_interval_ms) {
-                pv_t *pv = pv_find(g_clients[i].monitor_pv);
-                if (pv != NULL) {
-                    char data_msg[BEAMLINE_RESPONSE_BUFFER_SIZE];
-                    char value_str[64];
-                    snprintf(value_str, sizeof(value_str), "%.6g", pv_get(pv));
-                    snprintf(data_msg, sizeof(data_msg), "DATA:%s\n", value_str);
-                    send(g_clients[i].fd, data_msg, strlen(data_msg), 0);
-                }
-                g_clients[i].last_monitor_time = now;
+    // Delivery pass: flush each due client's pending set as one frame.
+    // Runs even with nothing newly dirty, since parked updates come due
+    // on the clock (next_wakeup_ms() tracks the same deadline).
+    int64_t now = get_time_ms();
+    for (int i = worker->slot_base; i < worker->slot_base + worker->slot_count; i++) {
+        client_t *client = &g_clients[i];
+        if (!client->active || !client->monitoring || client->monitor_pending == 0) {
+            continue;
+        }
+        if (now - client->last_monitor_time < client->monitor_interval_ms) {
+            continue; // Rate-limited; the pending bitmap keeps the update parked
+        }
+
+        pv_t *batch[BEAMLINE_MAX_CMD_TARGETS];
+        int batch_count = 0;
+        uint32_t pend = client->monitor_pending;
+        while (pend != 0) {
+            int j = __builtin_ctz(pend);
+            pend &= pend - 1;
+            pv_t *pv = pv_from_handle(client->monitor_pvs[j]);
+            if (pv != NULL) {
+                batch[batch_count++] = pv;
             }
         }
+
+        char data_msg[BEAMLINE_RESPONSE_BUFFER_SIZE];
+        size_t msg_len = format_data_frame(client, batch, batch_count, data_msg, sizeof(data_msg));
+        if (msg_len > 0) {
+            client_send(client, data_msg, msg_len);
+            client->last_monitor_time = now;
+            client->monitor_pending = 0;
+        }
     }
 }
 
-void server_run_once(int listen_fd) {
-    fd_set read_fds;
-    int max_fd;
-    setup_select_fds(listen_fd, &read_fds, &max_fd);
+// Helper: Milliseconds until the next timed obligation of one worker, or
+// -1 to block until a socket becomes ready. Monitor delivery and scan row
+// emission are the only work driven by time rather than fd readiness:
+// each monitoring client is due at last_monitor_time + interval (but
+// never sooner than the next simulation tick, since fresh values only
+// appear tick-by-tick), and an active scan needs servicing every tick to
+// catch sample crossings. With no monitors and no scans the loop is
+// fully tickless and sleeps until a command arrives.
+static int next_wakeup_ms(const worker_t *worker) {
+    int64_t now = get_time_ms();
+    int64_t deadline = INT64_MAX;
 
-    struct timeval timeout = {
-        .tv_sec = 0,
-        .tv_usec = (long) BEAMLINE_SELECT_TIMEOUT_MS * 1000L,
-    };
+    for (int i = worker->slot_base; i < worker->slot_base + worker->slot_count; i++) {
+        const client_t *client = &g_clients[i];
+        if (!client->active || !client->monitoring) {
+            continue;
+        }
+        int64_t due = client->last_monitor_time + client->monitor_interval_ms;
+        int64_t earliest = now + BEAMLINE_MOTOR_UPDATE_INTERVAL_MS;
+        if (due < earliest) {
+            due = earliest;
+        }
+        if (due < deadline) {
+            deadline = due;
+        }
+    }
 
-    int nready = select(max_fd + 1, &read_fds, NULL, NULL, &timeout);
+    if (scan_any_active(worker->slot_base, worker->slot_count)) {
+        int64_t due = now + BEAMLINE_MOTOR_UPDATE_INTERVAL_MS;
+        if (due < deadline) {
+            deadline = due;
+        }
+    }
+
+    if (worker->id == 0 && mcast_active()) {
+        int64_t due = mcast_deadline_ms();
+        if (due < now) {
+            due = now;
+        }
+        if (due < deadline) {
+            deadline = due;
+        }
+    }
+
+    // An interrupted burst is runnable immediately; just poll for fds
+    for (int i = worker->slot_base; i < worker->slot_base + worker->slot_count; i++) {
+        if (g_clients[i].active && g_clients[i].pending) {
+            return 0;
+        }
+    }
+
+    if (deadline == INT64_MAX) {
+        return -1;
+    }
+    // Undrained notifications are ready now; don't sleep past them
+    if (pv_dirty_depth(worker->id) > 0) {
+        return 0;
+    }
+    return (int) (deadline - now);
+}
+
+// Helper: Resume clients whose bursts ran out of budget, starting from a
+// rotating slot so resumption is round-robin fair across the shard
+static void service_pending(worker_t *worker) {
+    for (int i = 0; i < worker->slot_count; i++) {
+        int slot = worker->slot_base + (worker->rr_next + i) % worker->slot_count;
+        client_t *client = &g_clients[slot];
+        if (client->active && client->pending) {
+            client_process(client);
+        }
+    }
+    worker->rr_next = (worker->rr_next + 1) % worker->slot_count;
+}
+
+// Helper: One iteration of a worker's event loop
+static void worker_run_once(worker_t *worker) {
+    event_ready_t ready[BEAMLINE_MAX_CLIENTS + 3];
+    uint64_t t_wait = stats_now_ns();
+    int nready = event_wait(worker->events, next_wakeup_ms(worker), ready,
+                            (int) (sizeof(ready) / sizeof(ready[0])));
+    uint64_t t_dispatch = stats_now_ns();
+    stats_record(STAT_WAIT, t_dispatch - t_wait);
     if (nready < 0) {
         if (errno != EINTR) {
-            log_error("select() failed: %s", strerror(errno));
+            log_error("event_wait() failed: %s", strerror(errno));
         }
         return;
     }
 
-    // Check for new connection
-    if (FD_ISSET(listen_fd, &read_fds)) {
-        client_accept(listen_fd);
+    // Dispatch only the fds the backend reported as ready
+    for (int i = 0; i < nready; i++) {
+        if (ready[i].fd == g_stop_pipe[0]) {
+            // server_cleanup() closed the write end; time to exit
+            atomic_store_explicit(&g_workers_stop, true, memory_order_relaxed);
+            continue;
+        }
+        if (ready[i].fd == worker->listen_fd ||
+            (worker->id == 0 && g_unix_listen_fd >= 0 && ready[i].fd == g_unix_listen_fd)) {
+            client_accept(worker, ready[i].fd);
+            continue;
+        }
+        client_t *client = client_for_fd(worker, ready[i].fd);
+        if (client == NULL) {
+            continue;
+        }
+        if (ready[i].writable) {
+            client_flush(client);
+        }
+        if (ready[i].readable && client->active) {
+            client_handle(client);
+        }
     }
 
-    // Handle client data (only for FDs that are ready)
+    // Resume any bursts interrupted by the command budget
+    service_pending(worker);
+
+    // Check monitoring for this worker's clients
+    check_monitoring(worker);
+
+    // Advance this worker's active fly scans
+    scan_service(worker->slot_base, worker->slot_count);
+
+    // Publish the multicast telemetry group if its interval elapsed
+    if (worker->id == 0) {
+        mcast_service(get_time_ms());
+    }
+
+    stats_record(STAT_DISPATCH, stats_now_ns() - t_dispatch);
+}
+
+static void *worker_main(void *arg) {
+    worker_t *worker = arg;
+    while (!atomic_load_explicit(&g_workers_stop, memory_order_relaxed)) {
+        worker_run_once(worker);
+    }
+    return NULL;
+}
+
+int server_init(void) {
+    if (event_init() < 0) {
+        log_error("Failed to initialize event backend");
+        return -1;
+    }
+
+    // Worker count: BEAMLINE_WORKERS env var, default 1 (the proven
+    // single-loop configuration)
+    int nworkers = 1;
+    const char *workers_env = getenv("BEAMLINE_WORKERS");
+    if (workers_env != NULL && workers_env[0] != '\0') {
+        nworkers = atoi(workers_env);
+        if (nworkers < 1) {
+            nworkers = 1;
+        }
+        if (nworkers > BEAMLINE_MAX_WORKERS) {
+            log_warn("BEAMLINE_WORKERS capped at %d", BEAMLINE_MAX_WORKERS);
+            nworkers = BEAMLINE_MAX_WORKERS;
+        }
+    }
+    g_worker_count = nworkers;
+    g_slots_per_worker = BEAMLINE_MAX_CLIENTS / nworkers;
+    devices_set_workers(nworkers);
+
     for (int i = 0; i < BEAMLINE_MAX_CLIENTS; i++) {
-        if ((int) g_clients[i].active && FD_ISSET(g_clients[i].fd, &read_fds)) {
-            client_handle(&g_clients[i]);
+        g_clients[i].active = false;
+    }
+    g_client_count = 0;
+    g_workers_stop = false;
+
+    if (pipe(g_stop_pipe) < 0) {
+        log_error("pipe() failed: %s", strerror(errno));
+        return -1;
+    }
+
+    for (int w = 0; w < nworkers; w++) {
+        worker_t *worker = &g_workers[w];
+        worker->id = w;
+        worker->thread_started = false;
+        worker->listen_fd = -1;
+        worker->slot_base = w * g_slots_per_worker;
+        worker->slot_count = (w == nworkers - 1) ? BEAMLINE_MAX_CLIENTS - worker->slot_base
+                                                 : g_slots_per_worker;
+        worker->events = event_ctx_open();
+        if (worker->events == NULL) {
+            log_error("Failed to open event context for worker %d", w);
+            server_cleanup();
+            return -1;
+        }
+        worker->listen_fd = tcp_listener_init();
+        if (worker->listen_fd < 0 || event_add_fd(worker->events, worker->listen_fd) < 0) {
+            log_error("Failed to set up listener for worker %d", w);
+            server_cleanup();
+            return -1;
+        }
+        if (event_add_fd(worker->events, g_stop_pipe[0]) < 0) {
+            log_error("Failed to register stop pipe with worker %d", w);
+            server_cleanup();
+            return -1;
+        }
+    }
+
+    g_unix_listen_fd = unix_listener_init(g_workers[0].events);
+    mcast_init(); // Optional telemetry fan-out; disabled without env config
+
+    // Workers 1..N-1 run their own loops; block signals around the
+    // creation so SIGINT/SIGTERM always interrupt the main thread's wait
+    sigset_t blocked;
+    sigset_t saved;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &blocked, &saved);
+    for (int w = 1; w < nworkers; w++) {
+        if (pthread_create(&g_workers[w].thread, NULL, worker_main, &g_workers[w]) != 0) {
+            log_error("Failed to start worker thread %d", w);
+            pthread_sigmask(SIG_SETMASK, &saved, NULL);
+            server_cleanup();
+            return -1;
         }
+        g_workers[w].thread_started = true;
+    }
+    pthread_sigmask(SIG_SETMASK, &saved, NULL);
+
+    if (nworkers > 1) {
+        log_info("Sharded execution: %d workers, %d client slots each", nworkers,
+                 g_slots_per_worker);
     }
+    return 0;
+}
+
+void server_run_once(void) {
+    worker_run_once(&g_workers[0]);
+}
 
-    // Check monitoring for all active clients
-    check_monitoring();
+void server_send(int client_slot, const char *data, size_t len) {
+    if (client_slot < 0 || client_slot >= BEAMLINE_MAX_CLIENTS) {
+        return;
+    }
+    client_send(&g_clients[client_slot], data, len);
 }
 
-void server_cleanup(int listen_fd) {
+void server_cleanup(void) {
+    // Wake every worker thread (EOF on the stop pipe) and reap them
+    // before touching shared client state single-threaded
+    atomic_store_explicit(&g_workers_stop, true, memory_order_relaxed);
+    if (g_stop_pipe[1] >= 0) {
+        close(g_stop_pipe[1]);
+        g_stop_pipe[1] = -1;
+    }
+    for (int w = 1; w < g_worker_count; w++) {
+        if (g_workers[w].thread_started) {
+            pthread_join(g_workers[w].thread, NULL);
+            g_workers[w].thread_started = false;
+        }
+    }
+
     // Disconnect all clients
     for (int i = 0; i < BEAMLINE_MAX_CLIENTS; i++) {
         if (g_clients[i].active) {
@@ -399,7 +1432,28 @@ void server_cleanup(int listen_fd) {
         }
     }
 
-    if (listen_fd >= 0) {
-        close(listen_fd);
+    if (g_unix_listen_fd >= 0) {
+        event_del_fd(g_workers[0].events, g_unix_listen_fd);
+        close(g_unix_listen_fd);
+        unlink(BEAMLINE_UNIX_SOCKET_PATH);
+        g_unix_listen_fd = -1;
     }
+
+    for (int w = 0; w < g_worker_count; w++) {
+        worker_t *worker = &g_workers[w];
+        if (worker->listen_fd >= 0 && worker->events != NULL) {
+            event_del_fd(worker->events, worker->listen_fd);
+            close(worker->listen_fd);
+            worker->listen_fd = -1;
+        }
+        event_ctx_close(worker->events);
+        worker->events = NULL;
+    }
+
+    if (g_stop_pipe[0] >= 0) {
+        close(g_stop_pipe[0]);
+        g_stop_pipe[0] = -1;
+    }
+
+    mcast_close();
 }
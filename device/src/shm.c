@@ -0,0 +1,110 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "shm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "utils.h"
+
+static void *g_map = NULL;
+static size_t g_map_size = 0;
+static shm_snap_header_t *g_hdr = NULL;
+static uint64_t *g_hashes = NULL;
+static double *g_slots = NULL;
+
+// FNV-1a 64-bit (the PV index uses the 32-bit variant; readers need the
+// wider hash so name collisions are practically impossible)
+uint64_t shm_name_hash(const char *name) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const unsigned char *p = (const unsigned char *) name; *p != '\0'; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool shm_export_init(int count) {
+    shm_export_close(); // Re-init replaces any previous segment
+
+    size_t size = sizeof(shm_snap_header_t) +
+                  (size_t) count * (sizeof(uint64_t) + sizeof(double));
+
+    int fd = shm_open(BEAMLINE_SHM_NAME, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        log_warn("shm_open(%s) failed: %s", BEAMLINE_SHM_NAME, strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, (off_t) size) < 0) {
+        log_warn("ftruncate(%s) failed: %s", BEAMLINE_SHM_NAME, strerror(errno));
+        close(fd);
+        shm_unlink(BEAMLINE_SHM_NAME);
+        return false;
+    }
+
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        log_warn("mmap(%s) failed: %s", BEAMLINE_SHM_NAME, strerror(errno));
+        shm_unlink(BEAMLINE_SHM_NAME);
+        return false;
+    }
+
+    g_map = map;
+    g_map_size = size;
+    g_hdr = map;
+    g_hashes = (uint64_t *) ((char *) map + sizeof(shm_snap_header_t));
+    g_slots = (double *) (g_hashes + count);
+
+    memset(map, 0, size);
+    g_hdr->version = BEAMLINE_SHM_VERSION;
+    g_hdr->count = (uint32_t) count;
+    atomic_store_explicit(&g_hdr->seq, 0, memory_order_relaxed);
+    // Magic last: readers that see it can trust the rest of the header
+    atomic_thread_fence(memory_order_release);
+    g_hdr->magic = BEAMLINE_SHM_MAGIC;
+    return true;
+}
+
+void shm_export_set_hash(int idx, uint64_t hash) {
+    if (g_hdr == NULL || idx < 0 || (uint32_t) idx >= g_hdr->count) {
+        return;
+    }
+    g_hashes[idx] = hash;
+}
+
+// Seqlock publish, same idiom as the in-process snapshot in devices.c
+void shm_export_publish(const double *values, int count) {
+    if (g_hdr == NULL) {
+        return;
+    }
+    if ((uint32_t) count > g_hdr->count) {
+        count = (int) g_hdr->count;
+    }
+
+    uint64_t seq = atomic_load_explicit(&g_hdr->seq, memory_order_relaxed);
+    atomic_store_explicit(&g_hdr->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(g_slots, values, (size_t) count * sizeof(double));
+    atomic_store_explicit(&g_hdr->seq, seq + 2, memory_order_release);
+}
+
+void shm_export_close(void) {
+    if (g_map == NULL) {
+        return;
+    }
+    munmap(g_map, g_map_size);
+    shm_unlink(BEAMLINE_SHM_NAME);
+    g_map = NULL;
+    g_map_size = 0;
+    g_hdr = NULL;
+    g_hashes = NULL;
+    g_slots = NULL;
+}
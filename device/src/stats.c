@@ -0,0 +1,143 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "stats.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <time.h>
+
+// 40 power-of-two buckets cover 1 ns .. ~9 min per sample
+#define STATS_BUCKETS 40
+
+typedef struct {
+    _Atomic uint64_t count;
+    _Atomic uint64_t buckets[STATS_BUCKETS];
+} stats_hist_t;
+
+static stats_hist_t g_hists[STAT_CLASS_COUNT];
+static _Atomic uint64_t g_bytes_in = 0;
+static _Atomic uint64_t g_bytes_out = 0;
+static uint64_t g_start_ns = 0;
+
+// Class names, execution classes in cmd_type_t order
+static const char *const g_class_names[STAT_CLASS_COUNT] = {
+    [STAT_PARSE] = "parse",
+    [STAT_TICK] = "tick",
+    [STAT_WAIT] = "wait",
+    [STAT_DISPATCH] = "dispatch",
+    [STAT_EXEC_FIRST + CMD_GET] = "get",
+    [STAT_EXEC_FIRST + CMD_GETW] = "getw",
+    [STAT_EXEC_FIRST + CMD_GETHIST] = "gethist",
+    [STAT_EXEC_FIRST + CMD_SNAPSHOT] = "snapshot",
+    [STAT_EXEC_FIRST + CMD_PUT] = "put",
+    [STAT_EXEC_FIRST + CMD_MOVE] = "move",
+    [STAT_EXEC_FIRST + CMD_STATUS] = "status",
+    [STAT_EXEC_FIRST + CMD_LIST] = "list",
+    [STAT_EXEC_FIRST + CMD_MONITOR] = "monitor",
+    [STAT_EXEC_FIRST + CMD_SCAN] = "scan",
+    [STAT_EXEC_FIRST + CMD_STOP] = "stop",
+    [STAT_EXEC_FIRST + CMD_PING] = "ping",
+    [STAT_EXEC_FIRST + CMD_QUIT] = "quit",
+    [STAT_EXEC_FIRST + CMD_STATS] = "stats",
+    [STAT_EXEC_FIRST + CMD_BINARY] = "binary",
+    [STAT_EXEC_FIRST + CMD_INVALID] = "invalid",
+};
+
+uint64_t stats_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ull) + (uint64_t) ts.tv_nsec;
+}
+
+void stats_init(void) {
+    g_start_ns = stats_now_ns();
+}
+
+// Helper: log2 bucket index for a nanosecond sample
+static int bucket_index(uint64_t ns) {
+    if (ns == 0) {
+        return 0;
+    }
+    int bit = 63 - __builtin_clzll(ns);
+    return bit < STATS_BUCKETS ? bit : STATS_BUCKETS - 1;
+}
+
+void stats_record(stats_class_t cls, uint64_t elapsed_ns) {
+    if (cls < 0 || cls >= STAT_CLASS_COUNT) {
+        return;
+    }
+    stats_hist_t *h = &g_hists[cls];
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->buckets[bucket_index(elapsed_ns)], 1, memory_order_relaxed);
+}
+
+void stats_add_bytes_in(size_t n) {
+    atomic_fetch_add_explicit(&g_bytes_in, n, memory_order_relaxed);
+}
+
+void stats_add_bytes_out(size_t n) {
+    atomic_fetch_add_explicit(&g_bytes_out, n, memory_order_relaxed);
+}
+
+// Helper: Approximate percentile (bucket lower bound, in ns)
+static uint64_t hist_percentile_ns(const stats_hist_t *h, double pct) {
+    uint64_t total = atomic_load_explicit(&h->count, memory_order_relaxed);
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t) (pct * (double) total + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    uint64_t cum = 0;
+    for (int b = 0; b < STATS_BUCKETS; b++) {
+        cum += atomic_load_explicit(&h->buckets[b], memory_order_relaxed);
+        if (cum >= rank) {
+            return 1ull << b;
+        }
+    }
+    return 1ull << (STATS_BUCKETS - 1);
+}
+
+size_t stats_format(stats_format_params_t params) {
+    if (params.buf == NULL || params.len == 0) {
+        return 0;
+    }
+
+    size_t pos = 0;
+    int n = snprintf(params.buf, params.len,
+                     "uptime_s=%llu,clients=%d,bytes_in=%llu,bytes_out=%llu,"
+                     "sendq=%zu,dirty=%d",
+                     (unsigned long long) ((stats_now_ns() - g_start_ns) / 1000000000ull),
+                     params.clients,
+                     (unsigned long long) atomic_load_explicit(&g_bytes_in, memory_order_relaxed),
+                     (unsigned long long) atomic_load_explicit(&g_bytes_out, memory_order_relaxed),
+                     params.sendq_bytes, params.dirty_depth);
+    if (n < 0 || (size_t) n >= params.len) {
+        return 0;
+    }
+    pos = (size_t) n;
+
+    // Per-class count/p50/p99 in µs; classes never hit are omitted
+    for (int c = 0; c < STAT_CLASS_COUNT; c++) {
+        uint64_t count = atomic_load_explicit(&g_hists[c].count, memory_order_relaxed);
+        if (count == 0 || g_class_names[c] == NULL) {
+            continue;
+        }
+        uint64_t p50 = hist_percentile_ns(&g_hists[c], 0.50) / 1000;
+        uint64_t p99 = hist_percentile_ns(&g_hists[c], 0.99) / 1000;
+        n = snprintf(params.buf + pos, params.len - pos, ",%s=%llu/%lluus/%lluus",
+                     g_class_names[c], (unsigned long long) count, (unsigned long long) p50,
+                     (unsigned long long) p99);
+        if (n < 0 || (size_t) n >= params.len - pos) {
+            break;
+        }
+        pos += (size_t) n;
+    }
+
+    return pos;
+}
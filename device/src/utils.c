@@ -5,68 +5,189 @@
 #include "utils.h"
 
 #include <errno.h>
+#include <pthread.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
-// Logging implementation
-void log_init(void) {
-    // Using stderr for logging (can be changed to syslog later)
+// Asynchronous logging: producers format into a lock-free MPSC ring
+// (Vyukov bounded queue) and a background thread drains to stderr, so a
+// log storm on the event-loop or simulation thread costs a vsnprintf
+// into a preallocated cell instead of localtime() plus unbuffered
+// stderr writes. Until log_init() starts the drain thread (unit tests,
+// benches), messages fall back to the old synchronous path.
+
+#define LOG_RING_SIZE 1024 // Power of two
+#define LOG_MSG_MAX 232
+
+typedef struct {
+    _Atomic uint64_t seq; // Vyukov sequence: pos when free, pos+1 when full
+    int level;
+    time_t sec;           // Coarse wall-clock seconds at enqueue
+    char msg[LOG_MSG_MAX];
+} log_cell_t;
+
+static log_cell_t g_log_ring[LOG_RING_SIZE];
+static _Atomic uint64_t g_log_tail = 0; // Producers
+static uint64_t g_log_head = 0;         // Drain thread only
+static _Atomic uint64_t g_log_dropped = 0;
+static _Atomic int64_t g_log_coarse_sec = 0; // Updated by the drain thread
+static _Atomic bool g_log_async = false;
+static bool g_log_running = false;
+static pthread_t g_log_thread;
+
+static const char *const g_log_level_names[] = {"INFO", "WARN", "ERROR"};
+
+// Helper: Timestamped synchronous write (pre-init fallback and drain path)
+static void log_write_line(int level, time_t sec, const char *msg) {
+    struct tm tm_info;
+    localtime_r(&sec, &tm_info);
+    fprintf(stderr, "[%04d-%02d-%02d %02d:%02d:%02d] %s: %s\n", tm_info.tm_year + 1900,
+            tm_info.tm_mon + 1, tm_info.tm_mday, tm_info.tm_hour, tm_info.tm_min,
+            tm_info.tm_sec, g_log_level_names[level], msg);
+}
+
+// Helper: Drain every completed cell, in order (drain thread / shutdown)
+static void log_drain(void) {
+    for (;;) {
+        log_cell_t *cell = &g_log_ring[g_log_head & (LOG_RING_SIZE - 1)];
+        uint64_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        if (seq != g_log_head + 1) {
+            break; // Next cell not ready
+        }
+        log_write_line(cell->level, cell->sec, cell->msg);
+        atomic_store_explicit(&cell->seq, g_log_head + LOG_RING_SIZE, memory_order_release);
+        g_log_head++;
+    }
+
+    uint64_t dropped = atomic_exchange_explicit(&g_log_dropped, 0, memory_order_relaxed);
+    if (dropped > 0) {
+        log_write_line(1, (time_t) atomic_load_explicit(&g_log_coarse_sec,
+                                                        memory_order_relaxed),
+                       "Log ring overflow, messages dropped");
+    }
+}
+
+static void *log_thread_main(void *arg) {
+    (void) arg;
+    const struct timespec interval = {.tv_sec = 0, .tv_nsec = 20000000L}; // 20 ms
+
+    while (g_log_running) {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        atomic_store_explicit(&g_log_coarse_sec, (int64_t) now.tv_sec,
+                              memory_order_relaxed);
+        log_drain();
+        nanosleep(&interval, NULL);
+    }
+    log_drain(); // Final flush
+    return NULL;
+}
+
+// Helper: Enqueue one formatted message; drops (and counts) on overflow
+// rather than ever blocking the caller
+static void log_enqueue(int level, const char *fmt, va_list args) {
+    uint64_t pos = atomic_load_explicit(&g_log_tail, memory_order_relaxed);
+    log_cell_t *cell;
+    for (;;) {
+        cell = &g_log_ring[pos & (LOG_RING_SIZE - 1)];
+        uint64_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        int64_t dif = (int64_t) seq - (int64_t) pos;
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&g_log_tail, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            atomic_fetch_add_explicit(&g_log_dropped, 1, memory_order_relaxed);
+            return; // Ring full
+        } else {
+            pos = atomic_load_explicit(&g_log_tail, memory_order_relaxed);
+        }
+    }
+
+    cell->level = level;
+    cell->sec = (time_t) atomic_load_explicit(&g_log_coarse_sec, memory_order_relaxed);
+    vsnprintf(cell->msg, sizeof(cell->msg), fmt, args);
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
 }
 
-void log_info(const char* fmt, ...) {
+static void log_dispatch(int level, const char *fmt, va_list args) {
+    if (atomic_load_explicit(&g_log_async, memory_order_acquire)) {
+        log_enqueue(level, fmt, args);
+        return;
+    }
+
+    // Synchronous fallback before log_init()
+    char msg[LOG_MSG_MAX];
+    vsnprintf(msg, sizeof(msg), fmt, args);
     struct timespec ts;
     clock_gettime(CLOCK_REALTIME, &ts);
-    struct tm* tm_info = localtime(&ts.tv_sec);
+    log_write_line(level, ts.tv_sec, msg);
+}
 
-    fprintf(stderr, "[%04d-%02d-%02d %02d:%02d:%02d] INFO: ",
-            tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday,
-            tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec);
+void log_init(void) {
+    if (g_log_running) {
+        return;
+    }
 
-    va_list args;
-    va_start(args, fmt);
-    vfprintf(stderr, fmt, args);
-    va_end(args);
-    fprintf(stderr, "\n");
-}
+    for (uint64_t i = 0; i < LOG_RING_SIZE; i++) {
+        atomic_store_explicit(&g_log_ring[i].seq, i, memory_order_relaxed);
+    }
+    g_log_head = 0;
+    g_log_tail = 0;
 
-void log_warn(const char* fmt, ...) {
     struct timespec ts;
     clock_gettime(CLOCK_REALTIME, &ts);
-    struct tm* tm_info = localtime(&ts.tv_sec);
+    atomic_store_explicit(&g_log_coarse_sec, (int64_t) ts.tv_sec, memory_order_relaxed);
+
+    g_log_running = true;
+    if (pthread_create(&g_log_thread, NULL, log_thread_main, NULL) != 0) {
+        g_log_running = false;
+        fprintf(stderr, "WARN: log drain thread failed to start, logging synchronously\n");
+        return;
+    }
+    atomic_store_explicit(&g_log_async, true, memory_order_release);
+}
 
-    fprintf(stderr, "[%04d-%02d-%02d %02d:%02d:%02d] WARN: ",
-            tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday,
-            tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec);
+void log_shutdown(void) {
+    if (!g_log_running) {
+        return;
+    }
+    atomic_store_explicit(&g_log_async, false, memory_order_release);
+    g_log_running = false;
+    pthread_join(g_log_thread, NULL);
+}
 
+void log_info(const char *fmt, ...) {
     va_list args;
     va_start(args, fmt);
-    vfprintf(stderr, fmt, args);
+    log_dispatch(0, fmt, args);
     va_end(args);
-    fprintf(stderr, "\n");
 }
 
-void log_error(const char* fmt, ...) {
-    struct timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
-    struct tm* tm_info = localtime(&ts.tv_sec);
-
-    fprintf(stderr, "[%04d-%02d-%02d %02d:%02d:%02d] ERROR: ",
-            tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday,
-            tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec);
+void log_warn(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    log_dispatch(1, fmt, args);
+    va_end(args);
+}
 
+void log_error(const char *fmt, ...) {
     va_list args;
     va_start(args, fmt);
-    vfprintf(stderr, fmt, args);
+    log_dispatch(2, fmt, args);
     va_end(args);
-    fprintf(stderr, "\n");
 }
 
-void log_debug(const char* fmt, ...) {
+void log_debug(const char *fmt, ...) {
     // Debug logging (can be enabled via compile flag)
-    (void)fmt;
+    (void) fmt;
 }
 
 // Memory safety
@@ -114,6 +235,147 @@ void trim(char* str) {
     }
 }
 
+// Helper: Emit the decimal exponent suffix ("e+07", "e-305") in the
+// two-digit-minimum form %.6g uses
+static size_t fmt_exponent(char *buf, int exp) {
+    size_t pos = 0;
+    buf[pos++] = 'e';
+    if (exp < 0) {
+        buf[pos++] = '-';
+        exp = -exp;
+    } else {
+        buf[pos++] = '+';
+    }
+
+    char tmp[4];
+    int ndig = 0;
+    do {
+        tmp[ndig++] = (char) ('0' + exp % 10);
+        exp /= 10;
+    } while (exp > 0);
+    while (ndig < 2) {
+        tmp[ndig++] = '0';
+    }
+    while (ndig > 0) {
+        buf[pos++] = tmp[--ndig];
+    }
+    return pos;
+}
+
+size_t fmt_double(char* buf, size_t len, double value) {
+    if (len < FMT_DOUBLE_MAX) {
+        // Undersized buffer: take the slow path rather than truncating
+        int n = snprintf(buf, len, "%.6g", value);
+        return (n > 0 && (size_t) n < len) ? (size_t) n : 0;
+    }
+
+    size_t pos = 0;
+    if (value != value) {
+        memcpy(buf, "nan", 4);
+        return 3;
+    }
+    if (value < 0.0) {
+        buf[pos++] = '-';
+        value = -value;
+    }
+    if (value > 1.7976931348623157e308) {
+        memcpy(buf + pos, "inf", 4);
+        return pos + 3;
+    }
+    if (value == 0.0) {
+        buf[pos++] = '0';
+        buf[pos] = '\0';
+        return pos;
+    }
+
+    // Normalize into [1, 10) tracking the decimal exponent; the stepped
+    // 1e16 scaling keeps the loop short across double's full range
+    const double original = value; // Sign-stripped, for the slow path below
+    int exp = 0;
+    if (value >= 10.0) {
+        while (value >= 1e16) {
+            value /= 1e16;
+            exp += 16;
+        }
+        while (value >= 10.0) {
+            value /= 10.0;
+            exp++;
+        }
+    } else if (value < 1.0) {
+        while (value < 1e-15) {
+            value *= 1e16;
+            exp -= 16;
+        }
+        while (value < 1.0) {
+            value *= 10.0;
+            exp--;
+        }
+    }
+
+    // Round to 6 significant digits; rounding can carry into a 7th. The
+    // normalization divides accumulate up to a few ulps of drift, so when
+    // the scaled value lands within that drift of a rounding boundary
+    // (x.5) the carry decision is a coin toss -- defer those rare inputs
+    // (e.g. 999999.5) to the libc formatter, which also settles exact
+    // ties the same way %.6g does.
+    double scaled_f = value * 100000.0;
+    double frac = scaled_f - (double) (uint64_t) scaled_f;
+    double edge = frac - 0.5;
+    if ((edge < 0.0 ? -edge : edge) < 1e-8) {
+        int n = snprintf(buf + pos, len - pos, "%.6g", original);
+        return (n > 0 && (size_t) n < len - pos) ? pos + (size_t) n : 0;
+    }
+    uint64_t scaled = (uint64_t) (scaled_f + 0.5);
+    if (scaled >= 1000000) {
+        scaled /= 10;
+        exp++;
+    }
+
+    char digits[6];
+    for (int i = 5; i >= 0; i--) {
+        digits[i] = (char) ('0' + scaled % 10);
+        scaled /= 10;
+    }
+    int ndig = 6;
+    while (ndig > 1 && digits[ndig - 1] == '0') {
+        ndig--;
+    }
+
+    if (exp < -4 || exp >= 6) {
+        // Scientific: d.ddddde±XX
+        buf[pos++] = digits[0];
+        if (ndig > 1) {
+            buf[pos++] = '.';
+            memcpy(buf + pos, digits + 1, (size_t) (ndig - 1));
+            pos += (size_t) (ndig - 1);
+        }
+        pos += fmt_exponent(buf + pos, exp);
+    } else if (exp >= 0) {
+        // Fixed, point inside or right of the digits: 123.456 / 123000
+        int int_digits = exp + 1;
+        for (int i = 0; i < int_digits; i++) {
+            buf[pos++] = i < ndig ? digits[i] : '0';
+        }
+        if (ndig > int_digits) {
+            buf[pos++] = '.';
+            memcpy(buf + pos, digits + int_digits, (size_t) (ndig - int_digits));
+            pos += (size_t) (ndig - int_digits);
+        }
+    } else {
+        // Fixed, leading zeros: 0.00123
+        buf[pos++] = '0';
+        buf[pos++] = '.';
+        for (int i = -1; i > exp; i--) {
+            buf[pos++] = '0';
+        }
+        memcpy(buf + pos, digits, (size_t) ndig);
+        pos += (size_t) ndig;
+    }
+
+    buf[pos] = '\0';
+    return pos;
+}
+
 bool str_to_double(const char* str, double* out) {
     if (str == NULL || out == NULL) {
         return false;
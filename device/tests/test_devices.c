@@ -1,3 +1,7 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <setjmp.h>
 #include <stdarg.h>
 #include <stddef.h>
@@ -5,7 +9,14 @@
 
 #include <cmocka.h>
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "devfile.h"
 #include "devices.h"
+#include "persist.h"
+#include "shm.h"
 
 static void test_pv_find(void **state) {
     (void) state;
@@ -40,6 +51,252 @@ static void test_pv_set_readonly(void **state) {
     assert_false(pv_set(pv, 100.0)); // Read-only
 }
 
+static void test_pv_handle(void **state) {
+    (void) state;
+    devices_init();
+    pv_handle_t handle = pv_handle("BL02:DET:I0");
+    assert_int_not_equal(handle, PV_HANDLE_INVALID);
+    pv_t *pv = pv_from_handle(handle);
+    assert_non_null(pv);
+    assert_string_equal(pv->name, "BL02:DET:I0");
+    assert_int_equal(pv_handle("BL02:DOES:NOT:EXIST"), PV_HANDLE_INVALID);
+    assert_null(pv_from_handle(PV_HANDLE_INVALID));
+}
+
+static void test_waveform_pv(void **state) {
+    (void) state;
+    devices_init();
+    pv_t *pv = pv_find("BL02:DET:MCA");
+    assert_non_null(pv);
+    assert_int_equal(pv->type, PV_WAVEFORM);
+    assert_int_equal(pv->nelem, BEAMLINE_WAVEFORM_MAX_ELEMENTS);
+
+    devices_update(0.01);
+    static double wave[BEAMLINE_WAVEFORM_MAX_ELEMENTS];
+    int count = pv_read_wave(pv, wave, BEAMLINE_WAVEFORM_MAX_ELEMENTS);
+    assert_int_equal(count, BEAMLINE_WAVEFORM_MAX_ELEMENTS);
+    assert_true(wave[0] >= 0.0);
+    assert_true(pv_read(pv) > 0.0); // Scalar value is integrated counts
+}
+
+static void test_pv_history(void **state) {
+    (void) state;
+    devices_init();
+    pv_t *pv = pv_find("BL02:VACUUM:PRESSURE");
+    assert_non_null(pv);
+    assert_int_equal(pv->hist_depth, 1024);
+
+    for (int i = 0; i < 5; i++) {
+        devices_update(0.01);
+    }
+    static pv_hist_sample_t samples[16];
+    int count = pv_read_hist(pv, samples, 16);
+    assert_int_equal(count, 5);
+    for (int i = 0; i < count; i++) {
+        assert_true(samples[i].value >= pv->min && samples[i].value <= pv->max);
+        if (i > 0) {
+            assert_true(samples[i].t_ms >= samples[i - 1].t_ms);
+        }
+    }
+
+    // PVs without a registered ring report no history
+    pv_t *bare = pv_find("BL02:DET:I0");
+    assert_non_null(bare);
+    assert_int_equal(pv_read_hist(bare, samples, 16), 0);
+}
+
+static void test_rng_determinism(void **state) {
+    (void) state;
+    // Same seed, same noise: two inits must reproduce the first tick
+    setenv("BEAMLINE_RNG_SEED", "1234", 1);
+    devices_init();
+    devices_update(0.01);
+    double first = pv_get(pv_find("BL02:RING:CURRENT"));
+
+    devices_init();
+    devices_update(0.01);
+    double second = pv_get(pv_find("BL02:RING:CURRENT"));
+    unsetenv("BEAMLINE_RNG_SEED");
+
+    assert_double_equal(first, second, 1e-12);
+}
+
+static void test_pv_list_prefix(void **state) {
+    (void) state;
+    devices_init();
+
+    // Prefix query resolves through the sorted index, in name order
+    char buf[1024];
+    int count = pv_list("BL02:DET:*", buf, sizeof(buf));
+    assert_int_equal(count, 4);
+    assert_string_equal(buf, "BL02:DET:I0,BL02:DET:IF,BL02:DET:IT,BL02:DET:MCA");
+
+    // Exact name, mid-string wildcard, and no-match prefix
+    assert_int_equal(pv_list("BL02:RING:CURRENT", buf, sizeof(buf)), 1);
+    assert_string_equal(buf, "BL02:RING:CURRENT");
+    assert_true(pv_list("BL02:*.RBV", buf, sizeof(buf)) > 0);
+    assert_non_null(strstr(buf, "BL02:SAMPLE:X.RBV"));
+    assert_int_equal(pv_list("BL09:*", buf, sizeof(buf)), 0);
+    assert_string_equal(buf, "");
+}
+
+static void test_dirty_fanout_per_worker(void **state) {
+    (void) state;
+    devices_init();
+    devices_set_workers(2);
+
+    // Slot 0 lands in worker 0's shard, the mirror slot in worker 1's
+    pv_t *pv = pv_find("BL02:RING:CURRENT");
+    assert_non_null(pv);
+    pv_subscribe(pv, 0, 0.0);
+    pv_subscribe(pv, BEAMLINE_MAX_CLIENTS / 2, 0.0);
+    devices_update(0.01);
+
+    // Both workers see the notification; draining one leaves the other
+    pv_t *got[4];
+    assert_int_equal(pv_take_dirty(0, got, 4), 1);
+    assert_ptr_equal(got[0], pv);
+    assert_int_equal(pv_take_dirty(0, got, 4), 0);
+    assert_int_equal(pv_take_dirty(1, got, 4), 1);
+    assert_ptr_equal(got[0], pv);
+
+    pv_unsubscribe_all(0);
+    pv_unsubscribe_all(BEAMLINE_MAX_CLIENTS / 2);
+    devices_set_workers(1);
+}
+
+static void test_pv_snapshot_text(void **state) {
+    (void) state;
+    devices_init();
+    devices_update(0.01);
+
+    const char *text = NULL;
+    int count = 0;
+    size_t len = pv_snapshot_text(&text, &count);
+    pv_snapshot_release();
+    assert_true(len > 0);
+    assert_non_null(text);
+    assert_true(count > 0);
+    assert_non_null(strstr(text, "BL02:RING:CURRENT="));
+
+    // One name=value line per PV
+    int lines = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (text[i] == '\n') {
+            lines++;
+        }
+    }
+    assert_int_equal(lines, count);
+
+    // Same tick: the cached buffer is reused as-is
+    const char *again = NULL;
+    assert_int_equal(pv_snapshot_text(&again, NULL), len);
+    pv_snapshot_release();
+    assert_ptr_equal(again, text);
+}
+
+static void test_state_warm_restart(void **state) {
+    (void) state;
+    const char *path = "/tmp/beamline_test_state.bin";
+    remove(path);
+    setenv("BEAMLINE_STATE_FILE", path, 1);
+
+    // First life: move a setpoint away from its default and persist
+    devices_init();
+    assert_true(devices_state_attach());
+    pv_t *pv = pv_find("BL02:MONO:ENERGY");
+    assert_non_null(pv);
+    assert_true(pv_set(pv, 12345.0));
+    devices_update(0.01);
+    persist_close();
+
+    // Second life: the restored registry resumes at the saved value
+    devices_init();
+    assert_true(devices_state_attach());
+    pv = pv_find("BL02:MONO:ENERGY");
+    assert_non_null(pv);
+    assert_double_equal(pv_get(pv), 12345.0, 0.001);
+
+    persist_close();
+    unsetenv("BEAMLINE_STATE_FILE");
+    remove(path);
+}
+
+static void test_shm_export(void **state) {
+    (void) state;
+    devices_init();
+    assert_true(devices_shm_export());
+    devices_update(0.01);
+
+    // Read the segment back the way an external client would
+    FILE *f = fopen("/dev/shm" BEAMLINE_SHM_NAME, "rb");
+    assert_non_null(f);
+    shm_snap_header_t hdr;
+    assert_int_equal(fread(&hdr, sizeof(hdr), 1, f), 1);
+    assert_int_equal(hdr.magic, BEAMLINE_SHM_MAGIC);
+    assert_int_equal(hdr.version, BEAMLINE_SHM_VERSION);
+    assert_true(hdr.count > 0);
+
+    static uint64_t hashes[BEAMLINE_MAX_PVS];
+    static double values[BEAMLINE_MAX_PVS];
+    assert_int_equal(fread(hashes, sizeof(uint64_t), hdr.count, f), hdr.count);
+    assert_int_equal(fread(values, sizeof(double), hdr.count, f), hdr.count);
+    fclose(f);
+
+    pv_t *pv = pv_find("BL02:RING:CURRENT");
+    assert_non_null(pv);
+    uint64_t want = shm_name_hash("BL02:RING:CURRENT");
+    bool found = false;
+    for (uint32_t i = 0; i < hdr.count; i++) {
+        if (hashes[i] == want) {
+            assert_double_equal(values[i], pv_get(pv), 1e-9);
+            found = true;
+        }
+    }
+    assert_true(found);
+    shm_export_close();
+}
+
+static void test_devfile_load(void **state) {
+    (void) state;
+    const char *path = "/tmp/beamline_test_devices.cfg";
+    FILE *f = fopen(path, "w");
+    assert_non_null(f);
+    fputs("# test device file\n"
+          "counts 2 1\n"
+          "pv TEST:SENSOR ai 0 100 noise\n"
+          "pv TEST:SETPOINT ao -1 1 none\n"
+          "motor TEST:M -10 10 5\n",
+          f);
+    fclose(f);
+
+    assert_true(devfile_load(path));
+    assert_non_null(pv_find("TEST:SENSOR"));
+    assert_non_null(pv_find("TEST:M.RBV"));
+    motor_t *motor = motor_find("TEST:M");
+    assert_non_null(motor);
+    assert_double_equal(motor->velocity, 5.0, 0.001);
+    assert_null(pv_find("BL02:RING:CURRENT")); // File replaces built-ins
+
+    // The dense noise sweep keeps file-defined PVs inside their range
+    devices_update(0.01);
+    double v = pv_get(pv_find("TEST:SENSOR"));
+    assert_true(v >= 0.0 && v <= 100.0);
+    remove(path);
+}
+
+static void test_devfile_reject_malformed(void **state) {
+    (void) state;
+    const char *path = "/tmp/beamline_test_bad.cfg";
+    FILE *f = fopen(path, "w");
+    assert_non_null(f);
+    fputs("pv TEST:NO:COUNTS ai 0 1 none\n", f); // Missing counts header
+    fclose(f);
+
+    assert_false(devfile_load(path));
+    remove(path);
+}
+
 static void test_motor_find(void **state) {
     (void) state;
     devices_init();
@@ -59,6 +316,28 @@ static void test_motor_move(void **state) {
     assert_double_equal(motor->target, 1000.0, 0.001);
 }
 
+static void test_motor_exact_arrival(void **state) {
+    (void) state;
+    devices_init();
+    motor_t *motor = motor_find("BL02:SAMPLE:X");
+    assert_non_null(motor);
+
+    // 4.5 ticks of travel: still moving through tick 4, lands on tick 5
+    double start = pv_get(motor->readback);
+    double dist = motor->velocity * 0.045;
+    assert_true(motor_move("BL02:SAMPLE:X", start + dist));
+    for (int i = 1; i <= 4; i++) {
+        devices_update(0.01);
+        assert_true(motor->moving);
+        // Closed-form position, not velocity*dt accumulation
+        assert_double_equal(pv_get(motor->readback),
+                            start + motor->velocity * 0.01 * i, 1e-6);
+    }
+    devices_update(0.01);
+    assert_false(motor->moving);
+    assert_double_equal(pv_get(motor->readback), start + dist, 1e-9);
+}
+
 static void test_motor_status(void **state) {
     (void) state;
     devices_init();
@@ -74,8 +353,20 @@ int main(void) {
         cmocka_unit_test(test_pv_get_set),
         cmocka_unit_test(test_pv_set_invalid_range),
         cmocka_unit_test(test_pv_set_readonly),
+        cmocka_unit_test(test_pv_handle),
+        cmocka_unit_test(test_waveform_pv),
+        cmocka_unit_test(test_pv_history),
+        cmocka_unit_test(test_rng_determinism),
+        cmocka_unit_test(test_pv_list_prefix),
+        cmocka_unit_test(test_dirty_fanout_per_worker),
+        cmocka_unit_test(test_pv_snapshot_text),
+        cmocka_unit_test(test_state_warm_restart),
+        cmocka_unit_test(test_shm_export),
+        cmocka_unit_test(test_devfile_load),
+        cmocka_unit_test(test_devfile_reject_malformed),
         cmocka_unit_test(test_motor_find),
         cmocka_unit_test(test_motor_move),
+        cmocka_unit_test(test_motor_exact_arrival),
         cmocka_unit_test(test_motor_status),
     };
 
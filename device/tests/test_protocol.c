@@ -6,11 +6,21 @@
 #include <cmocka.h>
 
 #include "protocol.h"
+#include "utils.h"
+
+// protocol_parse() tokenizes its input in place, so tests parse a mutable
+// copy of the command literal. cmd_t pointers stay valid (static buffer).
+static bool parse_line(const char* line, cmd_t* cmd) {
+    static char buf[BEAMLINE_CMD_BUFFER_SIZE];
+    strncpy(buf, line, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    return protocol_parse(buf, cmd);
+}
 
 static void test_parse_get(void** state) {
     (void)state;
     cmd_t cmd;
-    assert_true(protocol_parse("GET:BL02:RING:CURRENT\n", &cmd));
+    assert_true(parse_line("GET:BL02:RING:CURRENT\n", &cmd));
     assert_int_equal(cmd.type, CMD_GET);
     assert_string_equal(cmd.target, "BL02:RING:CURRENT");
     assert_false(cmd.has_value);
@@ -19,31 +29,55 @@ static void test_parse_get(void** state) {
 static void test_parse_put(void** state) {
     (void)state;
     cmd_t cmd;
-    assert_true(protocol_parse("PUT:BL02:MONO:ENERGY:7112\n", &cmd));
+    assert_true(parse_line("PUT:BL02:MONO:ENERGY:7112\n", &cmd));
     assert_int_equal(cmd.type, CMD_PUT);
     assert_string_equal(cmd.target, "BL02:MONO:ENERGY");
     assert_true(cmd.has_value);
     assert_double_equal(cmd.value, 7112.0, 0.001);
 }
 
+static void test_parse_get_batch(void** state) {
+    (void)state;
+    cmd_t cmd;
+    assert_true(parse_line("GET:BL02:DET:I0,BL02:DET:IT,BL02:DET:IF\n", &cmd));
+    assert_int_equal(cmd.type, CMD_GET);
+    assert_int_equal(cmd.target_count, 3);
+    assert_string_equal(cmd.targets[0], "BL02:DET:I0");
+    assert_string_equal(cmd.targets[1], "BL02:DET:IT");
+    assert_string_equal(cmd.targets[2], "BL02:DET:IF");
+    assert_string_equal(cmd.target, "BL02:DET:I0");
+}
+
+static void test_parse_put_batch(void** state) {
+    (void)state;
+    cmd_t cmd;
+    assert_true(parse_line("PUT:BL02:MONO:ENERGY=7112,BL02:SHUTTER:CMD=1\n", &cmd));
+    assert_int_equal(cmd.type, CMD_PUT);
+    assert_int_equal(cmd.target_count, 2);
+    assert_string_equal(cmd.targets[0], "BL02:MONO:ENERGY");
+    assert_double_equal(cmd.values[0], 7112.0, 0.001);
+    assert_string_equal(cmd.targets[1], "BL02:SHUTTER:CMD");
+    assert_double_equal(cmd.values[1], 1.0, 0.001);
+}
+
 static void test_parse_ping(void** state) {
     (void)state;
     cmd_t cmd;
-    assert_true(protocol_parse("PING\n", &cmd));
+    assert_true(parse_line("PING\n", &cmd));
     assert_int_equal(cmd.type, CMD_PING);
 }
 
 static void test_parse_quit(void** state) {
     (void)state;
     cmd_t cmd;
-    assert_true(protocol_parse("QUIT\n", &cmd));
+    assert_true(parse_line("QUIT\n", &cmd));
     assert_int_equal(cmd.type, CMD_QUIT);
 }
 
 static void test_parse_move(void** state) {
     (void)state;
     cmd_t cmd;
-    assert_true(protocol_parse("MOVE:BL02:SAMPLE:X:1000\n", &cmd));
+    assert_true(parse_line("MOVE:BL02:SAMPLE:X:1000\n", &cmd));
     assert_int_equal(cmd.type, CMD_MOVE);
     assert_string_equal(cmd.target, "BL02:SAMPLE:X");
     assert_true(cmd.has_value);
@@ -53,7 +87,7 @@ static void test_parse_move(void** state) {
 static void test_parse_status(void** state) {
     (void)state;
     cmd_t cmd;
-    assert_true(protocol_parse("STATUS:BL02:SAMPLE:X\n", &cmd));
+    assert_true(parse_line("STATUS:BL02:SAMPLE:X\n", &cmd));
     assert_int_equal(cmd.type, CMD_STATUS);
     assert_string_equal(cmd.target, "BL02:SAMPLE:X");
 }
@@ -61,12 +95,56 @@ static void test_parse_status(void** state) {
 static void test_parse_monitor(void** state) {
     (void)state;
     cmd_t cmd;
-    assert_true(protocol_parse("MONITOR:BL02:DET:I0:100\n", &cmd));
+    assert_true(parse_line("MONITOR:BL02:DET:I0:100\n", &cmd));
     assert_int_equal(cmd.type, CMD_MONITOR);
     assert_string_equal(cmd.target, "BL02:DET:I0");
     assert_int_equal(cmd.monitor_interval_ms, 100);
 }
 
+static void test_parse_monitor_deadband(void** state) {
+    (void)state;
+    cmd_t cmd;
+    assert_true(parse_line("MONITOR:BL02:HUTCH:TEMP:1000:0.5\n", &cmd));
+    assert_int_equal(cmd.type, CMD_MONITOR);
+    assert_string_equal(cmd.target, "BL02:HUTCH:TEMP");
+    assert_int_equal(cmd.monitor_interval_ms, 1000);
+    assert_double_equal(cmd.monitor_deadband, 0.5, 0.001);
+}
+
+static void test_parse_scan(void** state) {
+    (void)state;
+    cmd_t cmd;
+    assert_true(parse_line("SCAN:BL02:SAMPLE:X,BL02:DET:I0,BL02:DET:IT:0:100:5\n", &cmd));
+    assert_int_equal(cmd.type, CMD_SCAN);
+    assert_int_equal(cmd.target_count, 3);
+    assert_string_equal(cmd.targets[0], "BL02:SAMPLE:X");
+    assert_string_equal(cmd.targets[1], "BL02:DET:I0");
+    assert_double_equal(cmd.scan_start, 0.0, 0.001);
+    assert_double_equal(cmd.scan_stop, 100.0, 0.001);
+    assert_double_equal(cmd.scan_step, 5.0, 0.001);
+}
+
+static void test_parse_getw(void** state) {
+    (void)state;
+    cmd_t cmd;
+    assert_true(parse_line("GETW:BL02:DET:MCA\n", &cmd));
+    assert_int_equal(cmd.type, CMD_GETW);
+    assert_string_equal(cmd.target, "BL02:DET:MCA");
+    assert_false(parse_line("GETW:\n", &cmd));
+}
+
+static void test_parse_gethist(void** state) {
+    (void)state;
+    cmd_t cmd;
+    assert_true(parse_line("GETHIST:BL02:VACUUM:PRESSURE:500\n", &cmd));
+    assert_int_equal(cmd.type, CMD_GETHIST);
+    assert_string_equal(cmd.target, "BL02:VACUUM:PRESSURE");
+    assert_true(cmd.has_value);
+    assert_double_equal(cmd.value, 500.0, 0.001);
+    assert_false(parse_line("GETHIST:BL02:VACUUM:PRESSURE\n", &cmd));
+    assert_false(parse_line("GETHIST:BL02:VACUUM:PRESSURE:0\n", &cmd));
+}
+
 static void test_format_response(void** state) {
     (void)state;
     char buf[256];
@@ -81,17 +159,64 @@ static void test_format_error(void** state) {
     assert_string_equal(buf, "ERR:UNKNOWN_PV\n");
 }
 
+static void test_parse_snapshot(void** state) {
+    (void)state;
+    cmd_t cmd;
+    assert_true(parse_line("SNAPSHOT\n", &cmd));
+    assert_int_equal(cmd.type, CMD_SNAPSHOT);
+    assert_false(parse_line("SNAPSHOT:BL02:DET:I0\n", &cmd));
+}
+
+static void test_parse_binary(void** state) {
+    (void)state;
+    cmd_t cmd;
+    assert_true(parse_line("BINARY\n", &cmd));
+    assert_int_equal(cmd.type, CMD_BINARY);
+    assert_false(parse_line("BINARY:NOW\n", &cmd));
+}
+
+static void test_fmt_double(void** state) {
+    (void)state;
+    // fmt_double must stay wire-compatible with the old %.6g output
+    char buf[FMT_DOUBLE_MAX];
+    fmt_double(buf, sizeof(buf), 350.123456);
+    assert_string_equal(buf, "350.123");
+    fmt_double(buf, sizeof(buf), 0.0);
+    assert_string_equal(buf, "0");
+    fmt_double(buf, sizeof(buf), -0.5);
+    assert_string_equal(buf, "-0.5");
+    fmt_double(buf, sizeof(buf), 8000.0);
+    assert_string_equal(buf, "8000");
+    fmt_double(buf, sizeof(buf), 0.0001);
+    assert_string_equal(buf, "0.0001");
+    fmt_double(buf, sizeof(buf), 0.00001);
+    assert_string_equal(buf, "1e-05");
+    fmt_double(buf, sizeof(buf), 123456789.0);
+    assert_string_equal(buf, "1.23457e+08");
+    fmt_double(buf, sizeof(buf), 999999.5);
+    assert_string_equal(buf, "1e+06");
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_parse_get),
         cmocka_unit_test(test_parse_put),
+        cmocka_unit_test(test_parse_get_batch),
+        cmocka_unit_test(test_parse_put_batch),
         cmocka_unit_test(test_parse_ping),
         cmocka_unit_test(test_parse_quit),
         cmocka_unit_test(test_parse_move),
         cmocka_unit_test(test_parse_status),
         cmocka_unit_test(test_parse_monitor),
+        cmocka_unit_test(test_parse_monitor_deadband),
+        cmocka_unit_test(test_parse_scan),
+        cmocka_unit_test(test_parse_getw),
+        cmocka_unit_test(test_parse_gethist),
+        cmocka_unit_test(test_parse_snapshot),
+        cmocka_unit_test(test_parse_binary),
         cmocka_unit_test(test_format_response),
         cmocka_unit_test(test_format_error),
+        cmocka_unit_test(test_fmt_double),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);